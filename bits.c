@@ -6,16 +6,18 @@
  * dans le fichier (toujours du poids fort au faible).
  *
  * Pour v=11 nb=8 on va écrire les bits : 00001011 dans le fichier
+ *
+ * Jusqu'à NB_BITS_MAX bits sont posés en une seule fois,
+ * au delà on écrit d'abord les bits de poids fort.
  */
 
 void put_bits(struct bitstream *b, unsigned int nb, unsigned long v)
 {
-	Booleen bit;
-	while(nb) {
-		nb--;
-		bit = prend_bit(v, nb);
-		put_bit(b, bit);
+	if (nb > NB_BITS_MAX) {
+		put_mot(b, nb - NB_BITS_MAX, v >> NB_BITS_MAX);
+		nb = NB_BITS_MAX;
 	}
+	put_mot(b, nb, v);
 }
 
 
@@ -27,16 +29,40 @@ void put_bits(struct bitstream *b, unsigned int nb, unsigned long v)
  * 00->0 01->1 10->2 11->3
  */
 
-unsigned int get_bits(struct bitstream *b, unsigned int nb)
+unsigned long get_bits(struct bitstream *b, unsigned int nb)
+{
+	unsigned long res = 0;
+
+	if (nb > NB_BITS_MAX) {
+		res = get_mot(b, nb - NB_BITS_MAX) << NB_BITS_MAX;
+		nb = NB_BITS_MAX;
+	}
+	return res | get_mot(b, nb);
+}
+
+/*
+ * Lecture anticipée pour les décodeurs utilisant une table :
+ * on regarde les "nb" prochains bits (au moins 32 sont toujours
+ * disponibles, jusqu'à NB_BITS_MAX) sans les consommer.
+ * Après la fin du fichier on ne voit que des bits à 0.
+ *
+ * Le décodeur consomme ensuite la longueur du code reconnu
+ * avec "skip_bits" qui lance Exception_fichier_lecture si
+ * elle dépasse la fin du fichier.
+ */
+
+unsigned long peek_bits(struct bitstream *b, unsigned int nb)
+{
+	return peek_mot(b, nb);
+}
+
+void skip_bits(struct bitstream *b, unsigned int nb)
 {
-	unsigned int res = 0;
-	Booleen bit;
-	while(nb) {
-		nb--;
-		bit = get_bit(b); // 0 (faux) ou 1 (vrai)
-		res = 2*res + bit ;
+	while (nb > NB_BITS_MAX) {
+		skip_mot(b, NB_BITS_MAX);
+		nb -= NB_BITS_MAX;
 	}
-	return res;
+	skip_mot(b, nb);
 }
 
 /*
@@ -7,8 +7,10 @@
 
 struct bitstream ;
 
-void         put_bits(struct bitstream *b, unsigned int nb, unsigned long v) ;
-unsigned int get_bits(struct bitstream *b, unsigned int nb) ;
-void   put_bit_string(struct bitstream *b, const char *bits) ;
+void           put_bits(struct bitstream *b, unsigned int nb, unsigned long v) ;
+unsigned long  get_bits(struct bitstream *b, unsigned int nb) ;
+unsigned long peek_bits(struct bitstream *b, unsigned int nb) ;
+void          skip_bits(struct bitstream *b, unsigned int nb) ;
+void     put_bit_string(struct bitstream *b, const char *bits) ;
 
 #endif
@@ -125,3 +125,88 @@ void put_bit_string_tst()
       
 }
 
+
+void peek_bits_tst()
+{
+  int i ;
+  struct bitstream *s ;
+
+  s = open_bitstream("xxx", "w") ;
+  for(i=0; i<N; i++)
+    put_bits(s, 13, i) ;
+  close_bitstream(s) ;
+
+  s = open_bitstream("xxx", "r") ;
+  for(i=0; i<N; i++)
+    {
+      if ( peek_bits(s, 13) != i || peek_bits(s, 32) >> 19 != i )
+	{
+	  eprintf("peek_bits ne fonctionne pas, attendu : %d, lu : %d\n"
+		  , i, (int)peek_bits(s, 13)) ;
+	  return ;
+	}
+      if ( get_bits(s, 13) != i )
+	{
+	  eprintf("peek_bits ne doit pas consommer les bits\n") ;
+	  return ;
+	}
+    }
+  /*
+   * Il reste 13*N%8 bits à 0 dans le dernier octet
+   * puis la fin du fichier : peek_bits voit des 0.
+   */
+  if ( peek_bits(s, 32) != 0 )
+    {
+      eprintf("peek_bits après la fin du fichier doit voir des 0\n") ;
+      return ;
+    }
+  close_bitstream(s) ;
+}
+
+void skip_bits_tst()
+{
+  int i, reste ;
+  struct bitstream *s ;
+  volatile int t ;
+
+  peek_bits_tst() ;
+
+  s = open_bitstream("xxx", "r") ;
+  for(i=0; i<N; i+=2)
+    {
+      skip_bits(s, 13) ;
+      if ( i+1 < N && peek_bits(s, 13) != i+1 )
+	{
+	  eprintf("skip_bits ne fonctionne pas, attendu : %d, lu : %d\n"
+		  , i+1, (int)peek_bits(s, 13)) ;
+	  return ;
+	}
+      if ( i+1 < N )
+        skip_bits(s, 13) ;
+    }
+  reste = (8 - (13*N) % 8) % 8 ;
+  t = 0 ;
+  EXCEPTION(skip_bits(s, reste + 1) ;
+	    ,
+	    ,
+	    case Exception_fichier_lecture:
+	    t = 1 ;
+	    break ;
+	    ) ;
+  if ( t == 0 )
+    {
+      eprintf("skip_bits après la fin du fichier doit lancer l'exception\n") ;
+      return ;
+    }
+  skip_bits(s, reste) ;
+  close_bitstream(s) ;
+
+  s = open_bitstream("xxx", "r") ;
+  skip_bits(s, 13*(N-1)) ;
+  if ( get_bits(s, 13) != N-1 )
+    {
+      eprintf("skip_bits d'un grand nombre de bits ne fonctionne pas\n") ;
+      return ;
+    }
+  close_bitstream(s) ;
+}
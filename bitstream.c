@@ -1,3 +1,6 @@
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <pthread.h>
 #include "bitstream.h"
 #include "exception.h"
 
@@ -10,7 +13,55 @@
  * Le principe est simple on utilise un buffer d'entrée/sortie.
  * On ne fait réellement la sortie que lorsque le buffer est plein
  * ou l'entrée quand il est vide.
+ *
+ * Il y a en fait deux niveaux de buffer :
+ *    - un mot de 64 bits dans lequel on pose ou prend
+ *      jusqu'à NB_BITS_MAX bits avec un seul décalage.
+ *    - un tableau d'octets lu ou écrit par bloc avec fread/fwrite
+ *      pour ne pas faire un appel à fgetc/fputc par octet.
+ *
+ * Le flot peut aussi être en mémoire (voir "open_bitstream_memory"),
+ * le tableau d'octets est alors directement celui de l'appelant.
+ * Un fichier ouvert en lecture avec le mode "rm" est projeté en mémoire
+ * (mmap) et lu comme un flot en mémoire.
+ * Avec le mode "r&" ou "w&" les fread/fwrite sont faits par un fil
+ * d'exécution (thread) en parallèle du codage (voir "struct asynchrone").
+ */
+
+#define TAILLE_TAMPON 4096
+#define NB_TAMPONS    3
+
+
+/*
+ * Entrées/sorties asynchrones : un fil d'exécution fait les fread/fwrite
+ * sur un anneau de NB_TAMPONS tableaux d'octets.
+ *
+ * Les tampons "pleins" sont "premier_plein", "premier_plein+1"...
+ * (modulo NB_TAMPONS), il y en a "nb_pleins" :
+ *    - En écriture, ce sont les tampons remplis par le codeur
+ *      qui attendent le "fwrite". Le codeur remplit le tampon
+ *      qui suit le dernier plein.
+ *    - En lecture, ce sont les tampons lus par "fread" qui attendent
+ *      le décodeur. Le décodeur lit dans "premier_plein" ("tenu" est Vrai),
+ *      il reste compté plein tant qu'il n'est pas rendu.
+ * Un tampon lu de longueur nulle indique la fin du fichier.
+ *
+ * Les erreurs d'écriture sont notées dans "erreur" et recopiées
+ * dans celle du flot à chaque échange de tampon.
  */
+struct asynchrone
+ {
+  pthread_t        fil ;
+  pthread_mutex_t  verrou ;
+  pthread_cond_t   change ;		     /* "nb_pleins" ou "arret" */
+  unsigned int     premier_plein ;
+  unsigned int     nb_pleins ;
+  Booleen          tenu ;		     /* Lecture : premier en cours */
+  Booleen          arret ;		     /* Le flot est fermé */
+  int              erreur ;		     /* Exception du fil ou 0 */
+  size_t           longueurs[NB_TAMPONS] ;
+  unsigned char    tampons[NB_TAMPONS][TAILLE_TAMPON] ;
+ } ;
 
 
 /*
@@ -23,15 +74,252 @@
  * Pour la lecture, le procédé est inverse, on lit le buffer.
  * Puis on en extrait les bits un par un
  * jusqu'à ce qu'il soit vide.
+ *
+ * Les bits du buffer sont cadrés à gauche (poids fort).
+ * En lecture le premier bit à lire est le bit numéro NB_BITS - 1,
+ * il en reste "nb_bits_dans_buffer".
+ * En écriture la première place libre est le bit numéro "place" - 1.
+ *
+ * Le compteur de l'autre mode reste toujours à 0 : un "get" sur un flot
+ * en écriture ou un "put" sur un flot en lecture ne passe jamais
+ * par le cas rapide, c'est le cas lent (remplissage ou vidage du buffer)
+ * qui teste le mode et lance l'exception.
+ * Les cas rapides ne testent donc ni le mode ni ne lancent d'exception.
+ *
+ * Une erreur d'écriture dans le fichier est notée dans "erreur"
+ * et l'exception est lancée par la fonction appelée
+ * (put_mot, put_bit, flush_bitstream...), pas au fond des vidages.
  */
 struct bitstream
  {
   FILE          *fichier ;		     /* En lecture ou Ecriture */
   Buffer_Bit     buffer ;		     /* Tampon intermediaire */
-  Position_Bit   nb_bits_dans_buffer ;	     /* Nb bits dans le tampon */
+  Position_Bit   nb_bits_dans_buffer ;	     /* Lecture : bits à lire */
+  Position_Bit   place ;		     /* Ecriture : bits libres */
   Booleen        ecriture ;		     /* Faux, si ouvert avec "r" */
+  int            erreur ;		     /* Exception en attente ou 0 */
+  unsigned char *courant ;		     /* Prochain octet de "octets" */
+  unsigned char *fin ;			     /* Fin des octets lus/libres */
+  unsigned char **memoire ;		     /* Si flot en mémoire */
+  size_t        *taille ;		     /* Si flot en mémoire */
+  unsigned char *projection ;		     /* Si fichier projeté (mmap) */
+  size_t         taille_projection ;
+  struct asynchrone *asynchrone ;	     /* Si mode "r&" ou "w&" */
+  unsigned char  octets[TAILLE_TAMPON] ;     /* Tampon d'entrée/sortie */
  } ;
 
+/*
+ * Projette en mémoire la suite d'un fichier régulier ouvert en lecture
+ * (à partir de la position courante, l'entrée standard a pu être lue)
+ * puis on le lit comme un flot en mémoire : plus aucun appel
+ * de fonction par octet ou par bloc.
+ * Si ce n'est pas possible (tube, terminal...) on garde la lecture
+ * par "fread" en retournant Faux.
+ */
+
+static Booleen projette_fichier(struct bitstream *bs)
+{
+	struct stat st;
+	long position;
+	void *p;
+
+	position = ftell(bs->fichier);
+	if (position < 0 || fstat(fileno(bs->fichier), &st) != 0
+	    || !S_ISREG(st.st_mode) || st.st_size <= position)
+		return Faux;
+
+	p = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE
+		 , fileno(bs->fichier), 0);
+	if (p == MAP_FAILED)
+		return Faux;
+	madvise(p, st.st_size, MADV_SEQUENTIAL);
+
+	bs->projection = p;
+	bs->taille_projection = st.st_size;
+	bs->memoire = &bs->projection;
+	bs->taille = &bs->taille_projection;
+	bs->courant = bs->projection + position;
+	bs->fin = bs->projection + bs->taille_projection;
+	return Vrai;
+}
+
+/*
+ * Le fil d'écriture : écrit les tampons pleins dans l'ordre.
+ * Quand le flot est fermé il termine les écritures en attente.
+ */
+
+static void *fil_ecriture(void *p)
+{
+	struct bitstream *b = p;
+	struct asynchrone *a = b->asynchrone;
+	unsigned int i;
+	Booleen ok;
+
+	pthread_mutex_lock(&a->verrou);
+	for (;;) {
+		while (a->nb_pleins == 0 && !a->arret)
+			pthread_cond_wait(&a->change, &a->verrou);
+		if (a->nb_pleins == 0)
+			break;
+		i = a->premier_plein;
+		pthread_mutex_unlock(&a->verrou);
+		ok = fwrite(a->tampons[i], 1, a->longueurs[i], b->fichier)
+			== a->longueurs[i];
+		pthread_mutex_lock(&a->verrou);
+		if (!ok)
+			a->erreur = Exception_fichier_ecriture;
+		a->premier_plein = (i + 1) % NB_TAMPONS;
+		a->nb_pleins--;
+		pthread_cond_broadcast(&a->change);
+	}
+	pthread_mutex_unlock(&a->verrou);
+	return NULL;
+}
+
+/*
+ * Le fil de lecture : lit en avance tant qu'il y a un tampon libre.
+ * Il s'arrête après avoir lu la fin du fichier (tampon vide).
+ * S'il est bloqué dans "fread" (tube) quand on ferme le flot,
+ * la fermeture attend que "fread" retourne.
+ */
+
+static void *fil_lecture(void *p)
+{
+	struct bitstream *b = p;
+	struct asynchrone *a = b->asynchrone;
+	unsigned int i;
+	size_t nb;
+
+	pthread_mutex_lock(&a->verrou);
+	for (;;) {
+		while (a->nb_pleins == NB_TAMPONS && !a->arret)
+			pthread_cond_wait(&a->change, &a->verrou);
+		if (a->arret)
+			break;
+		i = (a->premier_plein + a->nb_pleins) % NB_TAMPONS;
+		pthread_mutex_unlock(&a->verrou);
+		nb = fread(a->tampons[i], 1, TAILLE_TAMPON, b->fichier);
+		pthread_mutex_lock(&a->verrou);
+		a->longueurs[i] = nb;
+		a->nb_pleins++;
+		pthread_cond_broadcast(&a->change);
+		if (nb == 0)
+			break;
+	}
+	pthread_mutex_unlock(&a->verrou);
+	return NULL;
+}
+
+/*
+ * Démarre le fil d'exécution du flot.
+ * Si ce n'est pas possible on garde les entrées/sorties synchrones.
+ */
+
+static void demarre_asynchrone(struct bitstream *bs)
+{
+	struct asynchrone *a;
+
+	ALLOUER(a, 1);
+	a->premier_plein = 0;
+	a->nb_pleins = 0;
+	a->tenu = Faux;
+	a->arret = Faux;
+	a->erreur = 0;
+	pthread_mutex_init(&a->verrou, NULL);
+	pthread_cond_init(&a->change, NULL);
+	bs->asynchrone = a;
+
+	if (pthread_create(&a->fil, NULL
+			   , bs->ecriture ? fil_ecriture : fil_lecture, bs)) {
+		pthread_mutex_destroy(&a->verrou);
+		pthread_cond_destroy(&a->change);
+		free(a);
+		bs->asynchrone = NULL;
+		return;
+	}
+	if (bs->ecriture) {
+		bs->courant = a->tampons[0];
+		bs->fin = a->tampons[0] + TAILLE_TAMPON;
+	}
+}
+
+/*
+ * Ecriture : confie au fil le tampon rempli par le codeur
+ * et attend qu'il y en ait un libre pour continuer.
+ * Si "tout" est Vrai, on attend que tout soit écrit.
+ */
+
+static void confie_tampon(struct bitstream *b, Booleen tout)
+{
+	struct asynchrone *a = b->asynchrone;
+	unsigned int i;
+
+	pthread_mutex_lock(&a->verrou);
+	i = (a->premier_plein + a->nb_pleins) % NB_TAMPONS;
+	a->longueurs[i] = b->courant - a->tampons[i];
+	if (a->longueurs[i]) {
+		a->nb_pleins++;
+		pthread_cond_broadcast(&a->change);
+	}
+	while (a->nb_pleins == NB_TAMPONS || (tout && a->nb_pleins))
+		pthread_cond_wait(&a->change, &a->verrou);
+	i = (a->premier_plein + a->nb_pleins) % NB_TAMPONS;
+	if (a->erreur)
+		b->erreur = a->erreur;
+	pthread_mutex_unlock(&a->verrou);
+
+	b->courant = a->tampons[i];
+	b->fin = a->tampons[i] + TAILLE_TAMPON;
+}
+
+/*
+ * Lecture : rend au fil le tampon lu par le décodeur
+ * et attend le suivant.
+ * Retourne Faux en fin de fichier.
+ */
+
+static Booleen tampon_suivant(struct bitstream *b)
+{
+	struct asynchrone *a = b->asynchrone;
+	unsigned int i;
+
+	pthread_mutex_lock(&a->verrou);
+	if (a->tenu && a->longueurs[a->premier_plein]) {
+		a->premier_plein = (a->premier_plein + 1) % NB_TAMPONS;
+		a->nb_pleins--;
+		a->tenu = Faux;
+		pthread_cond_broadcast(&a->change);
+	}
+	while (a->nb_pleins == 0)
+		pthread_cond_wait(&a->change, &a->verrou);
+	a->tenu = Vrai;
+	i = a->premier_plein;
+	pthread_mutex_unlock(&a->verrou);
+
+	b->courant = a->tampons[i];
+	b->fin = a->tampons[i] + a->longueurs[i];
+	return a->longueurs[i] != 0;
+}
+
+/*
+ * Arrête le fil (il termine les écritures en attente) et libère tout.
+ */
+
+static void arrete_asynchrone(struct bitstream *b)
+{
+	struct asynchrone *a = b->asynchrone;
+
+	pthread_mutex_lock(&a->verrou);
+	a->arret = Vrai;
+	pthread_cond_broadcast(&a->change);
+	pthread_mutex_unlock(&a->verrou);
+	pthread_join(a->fil, NULL);
+	pthread_mutex_destroy(&a->verrou);
+	pthread_cond_destroy(&a->change);
+	free(a);
+	b->asynchrone = NULL;
+}
+
 /*
  * Cette fonction alloue la structure, l'initialise et ouvre le fichier.
  * Evidemment elle vide le buffer.
@@ -52,6 +340,15 @@ struct bitstream
  * Si le fichier ne peut être ouvert, on lance l'exception :
  *         "Exception_fichier_ouverture"
  * Pour plus d'explications sur les exceptions, regardez "exception.h"
+ *
+ * En lecture, si le mode contient 'm' (par exemple "rm") on essaye
+ * de projeter le fichier en mémoire (voir "projette_fichier").
+ *
+ * Si le mode contient '&' (par exemple "w&" ou "rm&") et que le fichier
+ * n'est pas projeté, les lectures ou écritures sont faites en parallèle
+ * par un fil d'exécution (voir "struct asynchrone").
+ * Il ne faut alors plus utiliser directement le fichier (FILE*)
+ * avant la fermeture du flot.
  */
 
 struct bitstream *open_bitstream(const char *fichier, const char* mode)
@@ -61,8 +358,17 @@ struct bitstream *open_bitstream(const char *fichier, const char* mode)
 
 	bs->buffer = 0; //Clear buffer
 	bs->nb_bits_dans_buffer = 0;
+	bs->memoire = NULL;
+	bs->taille = NULL;
+	bs->projection = NULL;
+	bs->asynchrone = NULL;
+	bs->erreur = 0;
 
 	bs->ecriture = mode[0] != 'r';
+	bs->place = bs->ecriture ? NB_BITS : 0;
+	//En écriture tout le tampon est libre, en lecture il est vide
+	bs->courant = bs->octets;
+	bs->fin = bs->ecriture ? bs->octets + TAILLE_TAMPON : bs->octets;
 
 	//const char * specialFile = "-";
 	if (strcmp(fichier, "-") == 0) {
@@ -85,39 +391,214 @@ struct bitstream *open_bitstream(const char *fichier, const char* mode)
 		bs->fichier = f;
 	} 
 
+	if (!bs->ecriture && strchr(mode, 'm') && projette_fichier(bs))
+		return bs;
+	if (strchr(mode, '&'))
+		demarre_asynchrone(bs);
+
 	return bs;
 }
 
+/*
+ * Ouverture d'un flot de bits en mémoire, sans fichier.
+ *
+ * En écriture ("w") "*octets" est un tableau alloué par "malloc"
+ * (ou NULL) qui appartient à l'appelant.
+ * "*taille" a deux sens (voir "bitstream.h") :
+ *    - A l'ouverture c'est la capacité de "*octets" (0 si NULL),
+ *      elle est lue puis "*taille" est remis à 0.
+ *    - Ensuite c'est le nombre d'octets écrits, mis à jour
+ *      par "flush_bitstream" et "close_bitstream".
+ * Le flot écrit directement dedans en l'agrandissant avec "realloc"
+ * quand il est plein : "*octets" peut donc changer.
+ * L'appelant libère "*octets".
+ *
+ * En lecture ("r") c'est "open_bitstream_memory_read(*octets, *taille)".
+ */
+
+struct bitstream *open_bitstream_memory(unsigned char **octets, size_t *taille
+					, const char *mode)
+{
+	struct bitstream* bs;
+
+	if (mode[0] == 'r')
+		return open_bitstream_memory_read(*octets, *taille);
+
+	ALLOUER(bs, 1);
+
+	bs->fichier = NULL;
+	bs->buffer = 0;
+	bs->nb_bits_dans_buffer = 0;
+	bs->memoire = octets;
+	bs->taille = taille;
+	bs->projection = NULL;
+	bs->asynchrone = NULL;
+	bs->erreur = 0;
+
+	bs->ecriture = Vrai;
+	bs->place = NB_BITS;
+	bs->courant = *octets;
+	bs->fin = *octets + *taille;
+	*taille = 0;
+
+	return bs;
+}
+
+/*
+ * Ouverture en lecture d'un flot de bits en mémoire :
+ * on lit les "taille" octets de "octets".
+ * Le tableau n'est ni copié, ni modifié, ni libéré,
+ * il doit rester valide jusqu'à "close_bitstream".
+ */
+
+struct bitstream *open_bitstream_memory_read(const unsigned char *octets
+					     , size_t taille)
+{
+	struct bitstream* bs;
+	ALLOUER(bs, 1);
+
+	bs->fichier = NULL;
+	bs->buffer = 0;
+	bs->nb_bits_dans_buffer = 0;
+	bs->memoire = NULL;
+	bs->taille = NULL;
+	bs->projection = NULL;
+	bs->asynchrone = NULL;
+	bs->erreur = 0;
+
+	bs->ecriture = Faux;
+	bs->place = 0;
+	//En lecture les octets ne sont jamais modifiés
+	bs->courant = (unsigned char*)octets;
+	bs->fin = bs->courant + taille;
+
+	return bs;
+}
+
+/*
+ * Ecrit dans le fichier les octets accumulés dans "octets".
+ * Pour un flot en mémoire, les octets y sont déjà,
+ * on met seulement à jour la taille.
+ * En mode asynchrone on les confie au fil d'écriture.
+ *
+ * Si il y a une erreur d'écriture, elle est notée dans "erreur"
+ * (les octets sont perdus) : voir "signale_erreur".
+ */
+
+static void ecrit_octets(struct bitstream *b)
+{
+	size_t nb;
+
+	if (b->memoire) {
+		*b->taille = b->courant - *b->memoire;
+		return;
+	}
+	if (b->asynchrone) {
+		confie_tampon(b, Faux);
+		return;
+	}
+
+	nb = b->courant - b->octets;
+	if (fwrite(b->octets, 1, nb, b->fichier) != nb)
+		b->erreur = Exception_fichier_ecriture;
+	b->courant = b->octets;
+}
+
+/*
+ * Lance l'exception notée par un vidage précédent.
+ * Elle reste notée : le flot est inutilisable.
+ */
+
+static void signale_erreur(const struct bitstream *b)
+{
+	if (b->erreur)
+		EXCEPTION_LANCE(b->erreur);
+}
+
+/*
+ * Le tableau d'octets est plein.
+ * On l'écrit dans le fichier ou, pour un flot en mémoire,
+ * on double sa taille.
+ */
+
+static void tampon_plein(struct bitstream *b)
+{
+	size_t utilises, capacite;
+	unsigned char *nouveau;
+
+	if (b->memoire == NULL) {
+		ecrit_octets(b);
+		return;
+	}
+	utilises = b->courant - *b->memoire;
+	capacite = 2 * utilises + TAILLE_TAMPON;
+	//Le tableau de l'appelant reste valide si "realloc" échoue
+	nouveau = realloc(*b->memoire, capacite);
+	if (nouveau == NULL) {
+		fprintf(stderr, "Plus de memoire\n");
+		EXIT;
+	}
+	*b->memoire = nouveau;
+	b->courant = nouveau + utilises;
+	b->fin = nouveau + capacite;
+}
+
+/*
+ * Transfère les octets complets du buffer vers le tableau "octets".
+ * Il reste au plus 7 bits dans le buffer.
+ */
+
+static void vide_buffer(struct bitstream *b)
+{
+	while (b->place <= NB_BITS - 8) {
+		if (b->courant == b->fin)
+			tampon_plein(b);
+		*b->courant++ = b->buffer >> (NB_BITS - 8);
+		b->buffer <<= 8;
+		b->place += 8;
+	}
+}
+
 /*
  * Cette fonction ne fait rien si le fichier est ouvert en lecture.
  * 
  * Si le buffer n'est pas vide :
  *    - Cette fonction stocke le buffer dans le fichier
- *      que le buffer soit "complet" ou non.
+ *      que le buffer soit "complet" ou non
+ *      (le dernier octet est complété par des bits à 0).
  *      Elle ne stocke rien si le buffer est vide
  *    - Elle vide ensuite le buffer.
  * Cette fonction n'est appelée que lorsque le fichier est ouvert
  * en écriture.
  *
- * Si il y a une erreur d'écriture, elle lance l'exception :
+ * Si il y a eu une erreur d'écriture (maintenant ou lors
+ * d'un vidage précédent), elle lance l'exception :
  *         "Exception_fichier_ecriture"  
  */
 
+/*
+ * Le travail de "flush_bitstream" sans lancer l'exception :
+ * l'erreur éventuelle reste notée dans "erreur".
+ */
+
+static void vide_tout(struct bitstream *b)
+{
+	//En écriture, on complète le dernier octet avec des 0
+	b->place -= b->place % 8;
+	vide_buffer(b);
+	if (b->asynchrone)
+		confie_tampon(b, Vrai);
+	else
+		ecrit_octets(b);
+}
+
 void flush_bitstream(struct bitstream *b)
 {
 	if(!b->ecriture)
 		return; //En lecture, on n'écrit pas!
 
-	//En écriture
-	if (b->nb_bits_dans_buffer != 0) {
-		//Buffer non vide
-
-		if (fputc(b->buffer, b->fichier) == EOF)
-			EXCEPTION_LANCE(Exception_fichier_ecriture);
-		//On vide le buffer
-		b->buffer = 0;
-		b->nb_bits_dans_buffer = 0;
-	}
+	vide_tout(b);
+	signale_erreur(b);
 }
 
 /*
@@ -125,29 +606,92 @@ void flush_bitstream(struct bitstream *b)
  * dans le fichier.
  * On ferme MEME si le fichier est l'entrée ou la sortie standard.
  *
- * Si jamais, il y a une erreur de fermeture, on lance l'exception
+ * Tout est libéré (fil, fichier, structure) AVANT de lancer
+ * une exception : le flot n'est plus utilisable dans tous les cas.
+ *
+ * Si il y a eu une erreur d'écriture, on lance l'exception
+ *         Exception_fichier_ecriture
+ * Sinon, si il y a une erreur de fermeture, on lance l'exception
  *         Exception_fichier_fermeture
  */
 
 void close_bitstream(struct bitstream *b)
 {
+	int erreur;
+
 	if (b->ecriture) {
 		//On flush si le fichier est en écriture
-		flush_bitstream(b);
+		vide_tout(b);
 	}
-	//On ferme le fichier
-	if (fclose(b->fichier) != 0)
-		EXCEPTION_LANCE(Exception_fichier_fermeture);
+	erreur = b->ecriture ? b->erreur : 0;
+	if (b->asynchrone)
+		arrete_asynchrone(b);
+	if (b->projection)
+		munmap(b->projection, b->taille_projection);
+	//On ferme le fichier (un flot en mémoire n'en a pas)
+	if (b->fichier && fclose(b->fichier) != 0 && erreur == 0)
+		erreur = Exception_fichier_fermeture;
 	//On free le bitstream
 	free(b);
+	if (erreur)
+		EXCEPTION_LANCE(erreur);
 }
 
 /*
- * Cette fonction ajoute le "bit" dans le buffer.
- *    - Si celui-ci est plein, alors on sauvegarde le buffer
- *      dans le fichier avec "flush_bitstream".
+ * Cas lent de "put_mot" : il n'y a pas la place dans le buffer,
+ * ou le flot est en lecture ("place" y vaut toujours 0), ou "nb" est nul.
+ *    - On teste le mode.
+ *    - On transfère les octets complets du buffer dans le tableau
+ *      "octets" avec "vide_buffer".
+ *    - On signale une éventuelle erreur d'écriture de ce vidage.
+ *    - On pose les bits dans le buffer.
+ *
+ * Si le fichier est ouvert en lecture, on lance l'exception
+ *         Exception_fichier_ecriture_dans_fichier_ouvert_en_lecture
+ */
+
+static void put_mot_lent(struct bitstream *b, unsigned int nb, Buffer_Bit v)
+{
+	if (!b->ecriture)
+		EXCEPTION_LANCE(Exception_fichier_ecriture_dans_fichier_ouvert_en_lecture);
+	if (nb == 0)
+		return;
+
+	vide_buffer(b);
+	signale_erreur(b);
+	b->place -= nb;
+	b->buffer |= (v & (((Buffer_Bit)1 << nb) - 1)) << b->place;
+}
+
+/*
+ * Cette fonction ajoute les "nb" bits de droite de "v" dans le buffer
+ * (du poids fort au poids faible) avec un seul décalage.
+ * Dans le cas courant il y a la place : pas de test du mode,
+ * pas d'exception. Sinon c'est "put_mot_lent".
+ * Le test "nb - 1 < place" (non signé) envoie aussi "nb == 0"
+ * dans le cas lent.
+ *
+ * "nb" vaut au plus NB_BITS_MAX.
  *
- *    - On pose le bit dans le buffer.
+ * Si le fichier est ouvert en lecture, on lance l'exception
+ *         Exception_fichier_ecriture_dans_fichier_ouvert_en_lecture
+ * Si un vidage a eu une erreur d'écriture, on lance l'exception
+ *         Exception_fichier_ecriture
+ */
+
+void put_mot(struct bitstream *b, unsigned int nb, Buffer_Bit v)
+{
+	if (nb - 1 < b->place) {
+		b->place -= nb;
+		//On ne garde que les "nb" bits de droite
+		b->buffer |= (v & (((Buffer_Bit)1 << nb) - 1)) << b->place;
+	}
+	else
+		put_mot_lent(b, nb, v);
+}
+
+/*
+ * Cette fonction ajoute le "bit" dans le buffer.
  *
  * Cette fonction n'est appelée que lorsque
  * le fichier est ouvert en écriture.
@@ -161,21 +705,151 @@ void close_bitstream(struct bitstream *b)
 
 void put_bit(struct bitstream *b, Booleen bit)
 {
+	if (b->place) {
+		b->place--;
+		b->buffer |= (Buffer_Bit)(bit != Faux) << b->place;
+	}
+	else
+		put_mot_lent(b, 1, bit != Faux);
+}
 
-	if (!b->ecriture)
-		EXCEPTION_LANCE(Exception_fichier_ecriture_dans_fichier_ouvert_en_lecture);
-	else {
-		//On écrit
-		//Si plein, on le vide
-		if (b->nb_bits_dans_buffer == NB_BITS)
-			flush_bitstream(b);
-		//On pose le bit dans le buffer, à la bonne position
-		Position_Bit pos = (NB_BITS - b->nb_bits_dans_buffer) - 1; //OK car b->nbBits < NB_BITS
-		b->buffer = pose_bit(b->buffer, pos, bit);
-		b->nb_bits_dans_buffer++;
+/*
+ * Le tableau "octets" a été entièrement lu, on le relit par bloc (fread)
+ * ou on prend le tampon suivant du fil de lecture.
+ * Un flot en mémoire est entièrement dans le tableau dès l'ouverture.
+ * Retourne Faux en fin de fichier.
+ */
+
+static Booleen recharge_tampon(struct bitstream *b)
+{
+	size_t nb;
+
+	if (b->fichier == NULL || b->projection)
+		return Faux;
+	if (b->asynchrone)
+		return tampon_suivant(b);
+	nb = fread(b->octets, 1, TAILLE_TAMPON, b->fichier);
+	b->courant = b->octets;
+	b->fin = b->octets + nb;
+	return nb != 0;
+}
+
+/*
+ * Complète le buffer avec les octets suivants du fichier
+ * tant qu'il y a la place pour un octet entier.
+ * En fin de fichier le buffer reste partiellement rempli.
+ *
+ * Si le fichier est ouvert en écriture, on lance l'exception
+ *         Exception_fichier_lecture_dans_fichier_ouvert_en_ecriture
+ */
+
+static void remplit_buffer(struct bitstream *b)
+{
+	if (b->ecriture)
+		EXCEPTION_LANCE(Exception_fichier_lecture_dans_fichier_ouvert_en_ecriture);
+
+	while (b->nb_bits_dans_buffer <= NB_BITS - 8) {
+		if (b->courant == b->fin && !recharge_tampon(b))
+			return;
+		b->buffer |= (Buffer_Bit)*b->courant++
+			<< (NB_BITS - 8 - b->nb_bits_dans_buffer);
+		b->nb_bits_dans_buffer += 8;
+	}
+}
+
+/*
+ * Cas lent de "get_mot" : le buffer ne contient pas assez de bits,
+ * ou le flot est en écriture ("nb_bits_dans_buffer" y vaut toujours 0),
+ * ou "nb" est nul.
+ * On remplit le buffer à partir du fichier (qui teste le mode).
+ *
+ * En cas d'erreur de lecture (fin de fichier) on lance l'exception
+ *         Exception_fichier_lecture
+ */
+
+static Buffer_Bit get_mot_lent(struct bitstream *b, unsigned int nb)
+{
+	Buffer_Bit v;
+
+	remplit_buffer(b);
+	if (nb == 0)
+		return 0;
+	if (b->nb_bits_dans_buffer < nb)
+		EXCEPTION_LANCE(Exception_fichier_lecture);
+
+	v = b->buffer >> (NB_BITS - nb);
+	b->buffer <<= nb;
+	b->nb_bits_dans_buffer -= nb;
+	return v;
+}
+
+/*
+ * Cette fonction lit "nb" bits (au plus NB_BITS_MAX) du buffer
+ * et les retourne cadrés à droite (poids faibles).
+ * Dans le cas courant ils sont dans le buffer : pas de test du mode,
+ * pas d'exception. Sinon c'est "get_mot_lent".
+ *
+ * En cas d'erreur de lecture (fin de fichier) on lance l'exception
+ *         Exception_fichier_lecture
+ *
+ * Si le fichier est ouvert en écriture, on lance l'exception
+ *         Exception_fichier_lecture_dans_fichier_ouvert_en_ecriture
+ */
+
+Buffer_Bit get_mot(struct bitstream *b, unsigned int nb)
+{
+	Buffer_Bit v;
+
+	if (nb - 1 < b->nb_bits_dans_buffer) {
+		v = b->buffer >> (NB_BITS - nb);
+		b->buffer <<= nb;
+		b->nb_bits_dans_buffer -= nb;
+		return v;
+	}
+	return get_mot_lent(b, nb);
+}
+
+/*
+ * Cette fonction retourne les "nb" prochains bits (au plus NB_BITS_MAX)
+ * cadrés à droite SANS les enlever du flot.
+ * En fin de fichier les bits manquants sont des 0 :
+ * c'est "skip_mot" qui lancera l'exception si on les consomme.
+ *
+ * Si le fichier est ouvert en écriture, on lance l'exception
+ *         Exception_fichier_lecture_dans_fichier_ouvert_en_ecriture
+ */
+
+Buffer_Bit peek_mot(struct bitstream *b, unsigned int nb)
+{
+	if (nb - 1 >= b->nb_bits_dans_buffer) {
+		remplit_buffer(b);
+		if (nb == 0)
+			return 0;
 	}
+	return b->buffer >> (NB_BITS - nb);
 }
 
+/*
+ * Enlève les "nb" prochains bits (au plus NB_BITS_MAX) du flot.
+ *
+ * S'il n'y a plus assez de bits dans le fichier, on lance l'exception
+ * (sans rien enlever)
+ *         Exception_fichier_lecture
+ *
+ * Si le fichier est ouvert en écriture, on lance l'exception
+ *         Exception_fichier_lecture_dans_fichier_ouvert_en_ecriture
+ */
+
+void skip_mot(struct bitstream *b, unsigned int nb)
+{
+	if (nb - 1 >= b->nb_bits_dans_buffer) {
+		remplit_buffer(b);
+		if (b->nb_bits_dans_buffer < nb)
+			EXCEPTION_LANCE(Exception_fichier_lecture);
+	}
+	b->buffer = nb < NB_BITS ? b->buffer << nb : 0;
+	b->nb_bits_dans_buffer -= nb;
+}
 
 /*
  * Cette fonction lit un bit du buffer (du poid fort au poid faible)
@@ -187,12 +861,6 @@ void put_bit(struct bitstream *b, Booleen bit)
  * Cette fonction n'est appelée que lorsque
  * le fichier est ouvert en lecture.
  *
- * ATTENTION ATTENTION : fgetc() RETOURNE UN int, PAS UN char.
- * faites donc attention aux affectations et aux tests par rapport à EOF.
- * Posez-vous les questions :
- *    - Pourquoi la valeur de retour est "int" et non "char"
- *    - Quel est le type de "b->buffer"
- *
  * En cas d'erreur de lecture (fin de fichier) on lance l'exception
  *         Exception_fichier_lecture
  *
@@ -201,23 +869,164 @@ void put_bit(struct bitstream *b, Booleen bit)
  */
 
 Booleen get_bit(struct bitstream *b)
+{
+	Booleen bit;
+
+	if (b->nb_bits_dans_buffer) {
+		bit = b->buffer >> (NB_BITS - 1);
+		b->buffer <<= 1;
+		b->nb_bits_dans_buffer--;
+		return bit;
+	}
+	return get_mot_lent(b, 1);
+}
+
+/*
+ * Cadre le flot sur une frontière d'octet.
+ *    - En écriture, on complète l'octet en cours avec des bits à 0.
+ *    - En lecture, on saute les bits qui restent de l'octet en cours.
+ * Il n'y a rien à faire si le flot est déjà cadré.
+ */
+
+void align_bitstream(struct bitstream *b)
 {
+	if (b->ecriture)
+		b->place -= b->place % 8;
+	else
+		skip_mot(b, b->nb_bits_dans_buffer % 8);
+}
+
+/*
+ * Ajoute "nb" octets déjà codés à la suite du flot (en écriture),
+ * après l'avoir cadré sur un octet.
+ * C'est ainsi qu'on met bout à bout des segments codés séparément
+ * (par exemple dans des flots en mémoire) sans les recoder.
+ *
+ * Si le fichier est ouvert en lecture, on lance l'exception
+ *         Exception_fichier_ecriture_dans_fichier_ouvert_en_lecture
+ * Si il y a une erreur d'écriture, on lance l'exception
+ *         Exception_fichier_ecriture
+ */
+
+void put_octets(struct bitstream *b, const unsigned char *octets, size_t nb)
+{
+	size_t n;
+
+	if (!b->ecriture)
+		EXCEPTION_LANCE(Exception_fichier_ecriture_dans_fichier_ouvert_en_lecture);
+
+	align_bitstream(b);
+	vide_buffer(b);
+	while (nb) {
+		if (b->courant == b->fin)
+			tampon_plein(b);
+		n = b->fin - b->courant;
+		if (n > nb)
+			n = nb;
+		memcpy(b->courant, octets, n);
+		b->courant += n;
+		octets += n;
+		nb -= n;
+	}
+	signale_erreur(b);
+}
+
+/*
+ * Lit les "nb" octets suivants du flot (en lecture) dans "octets",
+ * après l'avoir cadré sur un octet.
+ * C'est l'inverse de "put_octets" : on extrait un segment sans le décoder.
+ *
+ * En cas d'erreur de lecture (fin de fichier) on lance l'exception
+ *         Exception_fichier_lecture
+ *
+ * Si le fichier est ouvert en écriture, on lance l'exception
+ *         Exception_fichier_lecture_dans_fichier_ouvert_en_ecriture
+ */
+
+void get_octets(struct bitstream *b, unsigned char *octets, size_t nb)
+{
+	size_t n;
+
 	if (b->ecriture)
 		EXCEPTION_LANCE(Exception_fichier_lecture_dans_fichier_ouvert_en_ecriture);
 
-	if (b->nb_bits_dans_buffer == 0) {
-		//On lit dans le fichier
-		int c = fgetc(b->fichier);
-		if (c == EOF)
+	align_bitstream(b);
+	//D'abord les octets déjà dans le buffer
+	while (nb && b->nb_bits_dans_buffer) {
+		*octets++ = get_mot(b, 8);
+		nb--;
+	}
+	while (nb) {
+		if (b->courant == b->fin && !recharge_tampon(b))
 			EXCEPTION_LANCE(Exception_fichier_lecture);
-		//On peut le cast en unsigned char car c >= 0
-		b->buffer = (unsigned char) c;
-		b->nb_bits_dans_buffer = NB_BITS;
+		n = b->fin - b->courant;
+		if (n > nb)
+			n = nb;
+		memcpy(octets, b->courant, n);
+		b->courant += n;
+		octets += n;
+		nb -= n;
+	}
+}
+
+/*
+ * Marque une frontière de segment : on cadre le flot sur un octet
+ * puis on écrit l'entête du segment, les deux octets de MARQUEUR_SEGMENT
+ * suivis de la taille "nb" du segment sur 32 bits.
+ * Les "nb" octets du segment doivent suivre (par exemple avec "put_octets").
+ *
+ * Le segment est indépendant, son décodage reprend à zéro
+ * (nouveaux intstream, nouveaux modèles...) : les segments sont
+ * codés séparément (flot en mémoire) puis mis bout à bout.
+ * Grâce à la taille, un lecteur peut passer un segment sans le décoder
+ * (ou s'il est corrompu) et reprendre au suivant.
+ * Il n'y a pas de bourrage des octets 0xFF dans le segment :
+ * c'est la taille, pas le marqueur, qui donne la frontière suivante.
+ *
+ * Un segment de plus de 2^32-1 octets arrête le programme.
+ *
+ * Si le fichier est ouvert en lecture, on lance l'exception
+ * (sans toucher au flot)
+ *         Exception_fichier_ecriture_dans_fichier_ouvert_en_lecture
+ */
+
+void put_marqueur_segment(struct bitstream *b, size_t nb)
+{
+	if (!b->ecriture)
+		EXCEPTION_LANCE(Exception_fichier_ecriture_dans_fichier_ouvert_en_lecture);
+	if (nb > 0xFFFFFFFFu) {
+		fprintf(stderr, "Segment trop grand : %lu octets\n"
+			, (unsigned long)nb);
+		EXIT;
 	}
-	//Le buffer n'est plus vide
-	//On lit dans le buffer
-	b->nb_bits_dans_buffer--; //Ne peut pas être négative
-	return prend_bit(b->buffer, b->nb_bits_dans_buffer);
+	align_bitstream(b);
+	put_mot(b, 16, MARQUEUR_SEGMENT);
+	put_mot(b, 32, nb);
+}
+
+/*
+ * Lit un entête de segment écrit par "put_marqueur_segment" :
+ * on saute les bits de cadrage, on vérifie le marqueur
+ * et on retourne la taille du segment en octets.
+ *
+ * Si le marqueur n'est pas là, on lance l'exception
+ *         Exception_marqueur_segment_absent
+ * En fin de fichier on lance l'exception
+ *         Exception_fichier_lecture
+ *
+ * Si le fichier est ouvert en écriture, on lance l'exception
+ * (sans toucher au flot)
+ *         Exception_fichier_lecture_dans_fichier_ouvert_en_ecriture
+ */
+
+size_t get_marqueur_segment(struct bitstream *b)
+{
+	if (b->ecriture)
+		EXCEPTION_LANCE(Exception_fichier_lecture_dans_fichier_ouvert_en_ecriture);
+	align_bitstream(b);
+	if (get_mot(b, 16) != MARQUEUR_SEGMENT)
+		EXCEPTION_LANCE(Exception_marqueur_segment_absent);
+	return get_mot(b, 32);
 }
 
 /*
@@ -236,5 +1045,5 @@ Booleen bitstream_en_ecriture(const struct bitstream *b)
  }
 int bitstream_nb_bits_dans_buffer(const struct bitstream *b)
  {
-  return( b->nb_bits_dans_buffer ) ;
+  return( b->ecriture ? NB_BITS - b->place : b->nb_bits_dans_buffer ) ;
  }
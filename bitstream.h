@@ -9,22 +9,51 @@
 #include "bit.h"
 
 /*
- * Le buffer dans lequel on stocke les bits.
- * On pourrai prendre "long" mais il faudrait alors
- * déterminer si la machine est Little or Big Endian
+ * Le buffer dans lequel on stocke les bits : un mot machine (64 bits).
+ * Le problème Little/Big Endian ne se pose pas car le mot
+ * est toujours découpé en octets du poids fort au poids faible.
  */
-typedef unsigned char Buffer_Bit ;
+typedef unsigned long Buffer_Bit ;
 /*
  * Nombre de bit dans le buffer
  */
 #define NB_BITS (8*sizeof(Buffer_Bit))
+/*
+ * Nombre maximum de bits lus ou écrits en une seule opération.
+ * Il peut rester jusqu'à 7 bits (un octet incomplet) dans le buffer.
+ */
+#define NB_BITS_MAX (NB_BITS - 7)
+/*
+ * Les deux octets (cadrés) qui commencent l'entête d'un segment
+ * indépendant, ils sont suivis de la taille du segment sur 32 bits.
+ */
+#define MARQUEUR_SEGMENT 0xFFD0
 
+/*
+ * Flot en mémoire ouvert en écriture par "open_bitstream_memory" :
+ * "*taille" est en entrée la capacité du tableau "*octets" de l'appelant,
+ * puis en sortie (après "flush_bitstream" ou "close_bitstream")
+ * le nombre d'octets écrits, la capacité n'est plus visible.
+ * En lecture, "open_bitstream_memory_read" lit un tableau constant
+ * de "taille" octets sans le copier.
+ */
 struct bitstream ;
 
 struct bitstream  *open_bitstream(const char *fichier, const char* mode) ;
+struct bitstream  *open_bitstream_memory(unsigned char **octets, size_t *taille, const char *mode) ;
+struct bitstream  *open_bitstream_memory_read(const unsigned char *octets, size_t taille) ;
 void              close_bitstream(struct bitstream *b) ;
 void                      put_bit(struct bitstream *b, Booleen bit) ;
 Booleen 	          get_bit(struct bitstream *b) ;
+void                      put_mot(struct bitstream *b, unsigned int nb, Buffer_Bit v) ;
+Buffer_Bit                get_mot(struct bitstream *b, unsigned int nb) ;
+Buffer_Bit               peek_mot(struct bitstream *b, unsigned int nb) ;
+void                     skip_mot(struct bitstream *b, unsigned int nb) ;
+void              align_bitstream(struct bitstream *b) ;
+void                   put_octets(struct bitstream *b, const unsigned char *octets, size_t nb) ;
+void                   get_octets(struct bitstream *b, unsigned char *octets, size_t nb) ;
+void         put_marqueur_segment(struct bitstream *b, size_t nb) ;
+size_t       get_marqueur_segment(struct bitstream *b) ;
 
 FILE          *bitstream_get_file(const struct bitstream *b) ; /**/
 Booleen     bitstream_en_ecriture(const struct bitstream *b) ; /**/
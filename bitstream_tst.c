@@ -3,11 +3,194 @@
 #include <fcntl.h>
 
 #include "bitstream.h"
+#include "bits.h"
 #include "exception.h"
 #include "bases.h"
 
 void flush_bitstream(struct bitstream *b) ;
 
+/*
+ * Lecture avec le mode "rm" (fichier projeté en mémoire)
+ * d'un fichier contenant les octets 0 à 255 précédés de "saute" octets.
+ */
+static void open_bitstream_projection_test(int saute)
+{
+  struct bitstream *s ;
+  FILE *f ;
+  int c ;
+  volatile int t ;
+
+  f = fopen("xxx", "w") ;
+  for(c=0; c<saute; c++)
+    fputc('#', f) ;
+  for(c=0; c<256; c++)
+    fputc(c, f) ;
+  fclose(f) ;
+
+  s = open_bitstream("xxx", "rm") ;
+  if ( bitstream_en_ecriture(s) )
+    {
+      eprintf("Ouverture avec le mode 'rm' n'ouvre pas en lecture !\n") ;
+      return ;
+    }
+  for(c=0; c<saute; c++)
+    if ( get_bits(s, 8) != '#' )
+      {
+	eprintf("Mode 'rm' : l'octet %d est mal lu\n", c) ;
+	return ;
+      }
+  for(c=0; c<256; c++)
+    if ( get_bits(s, 8) != c )
+      {
+	eprintf("Mode 'rm' : l'octet %d est mal lu\n", c + saute) ;
+	return ;
+      }
+  t = 0 ;
+  EXCEPTION(get_bit(s) ;
+	    ,
+	    ,
+	    case Exception_fichier_lecture:
+	    t = 1 ;
+	    break ;
+	    ) ;
+  if ( t == 0 )
+    {
+      eprintf("Mode 'rm' : pas d'exception en fin de fichier\n") ;
+      return ;
+    }
+  close_bitstream(s) ;
+}
+
+static void open_bitstream_projection_tst()
+{
+  struct bitstream *s ;
+  int i, libre ;
+
+  libre = dup(0) ;
+  close(libre) ;
+  open_bitstream_projection_test(0) ;
+  open_bitstream_projection_test(10000) ;
+
+  /* Fichier vide */
+  fclose(fopen("xxx", "w")) ;
+  s = open_bitstream("xxx", "rm") ;
+  EXCEPTION(get_bit(s) ;
+	    eprintf("Mode 'rm' : pas d'exception sur un fichier vide\n") ;
+	    ,
+	    ,
+	    case Exception_fichier_lecture:
+	    break ;
+	    ) ;
+  close_bitstream(s) ;
+
+  /* Les fichiers sont bien fermés */
+  i = dup(0) ;
+  if ( i != libre )
+    {
+      eprintf("Mode 'rm' : un fichier n'est pas fermé, fildes=%d\n", i) ;
+      return ;
+    }
+  close(i) ;
+}
+
+/*
+ * Modes "w&" et "r&" : les entrées/sorties sont faites par un fil
+ * d'exécution, le fichier doit être le même qu'en mode synchrone.
+ */
+
+#define NB_OCTETS_ASYNCHRONE (7*4096 + 123)
+
+static void open_bitstream_asynchrone_tst()
+{
+  struct bitstream *s ;
+  FILE *f ;
+  int i, libre ;
+  volatile int t ;
+
+  libre = dup(0) ;
+  close(libre) ;
+
+  s = open_bitstream("xxx", "w&") ;
+  for(i=0; i<NB_OCTETS_ASYNCHRONE; i++)
+    {
+      put_bits(s, 8, (7*i) % 256) ;
+      if ( i == 5000 )
+	flush_bitstream(s) ;
+    }
+  close_bitstream(s) ;
+
+  f = fopen("xxx", "r") ;
+  for(i=0; i<NB_OCTETS_ASYNCHRONE; i++)
+    if ( fgetc(f) != (7*i) % 256 )
+      {
+	eprintf("Mode 'w&' : l'octet %d est mal écrit\n", i) ;
+	return ;
+      }
+  if ( fgetc(f) != EOF )
+    {
+      eprintf("Mode 'w&' : il y a des octets en trop\n") ;
+      return ;
+    }
+  fclose(f) ;
+
+  s = open_bitstream("xxx", "r&") ;
+  for(i=0; i<NB_OCTETS_ASYNCHRONE; i++)
+    if ( get_bits(s, 8) != (7*i) % 256 )
+      {
+	eprintf("Mode 'r&' : l'octet %d est mal lu\n", i) ;
+	return ;
+      }
+  t = 0 ;
+  EXCEPTION(get_bit(s) ;
+	    ,
+	    ,
+	    case Exception_fichier_lecture:
+	    t = 1 ;
+	    break ;
+	    ) ;
+  if ( t == 0 )
+    {
+      eprintf("Mode 'r&' : pas d'exception en fin de fichier\n") ;
+      return ;
+    }
+  close_bitstream(s) ;
+
+  /* Fermeture avant la fin de la lecture */
+  s = open_bitstream("xxx", "r&") ;
+  get_bits(s, 8) ;
+  close_bitstream(s) ;
+
+  /* Les erreurs d'écriture du fil sont signalées */
+  s = open_bitstream("/dev/full", "w&") ;
+  t = 0 ;
+  EXCEPTION(
+	    for(i=0; i<NB_OCTETS_ASYNCHRONE; i++)
+	      put_bits(s, 8, i) ;
+	    ,
+	    ,
+	    case Exception_fichier_ecriture: t = 1 ; break ;
+	    ) ;
+  /* La fermeture libère tout même si elle lance l'exception */
+  EXCEPTION(close_bitstream(s) ;
+	    ,
+	    ,
+	    case Exception_fichier_ecriture: t = 1 ; break ;
+	    ) ;
+  if ( t == 0 )
+    {
+      eprintf("Mode 'w&' : pas d'exception en écrivant dans /dev/full\n") ;
+      return ;
+    }
+
+  i = dup(0) ;
+  if ( i != libre ) /* "/dev/full" n'est pas fermé */
+    {
+      eprintf("Mode '&' : un fichier n'est pas fermé, fildes=%d\n", i) ;
+      return ;
+    }
+  close(i) ;
+}
+
 void open_bitstream_tst()
 {
   struct bitstream *r ;
@@ -146,6 +329,9 @@ void open_bitstream_tst()
       eprintf("d'ouverture de fichier impossible !\n");
       return ;
     }
+
+  open_bitstream_projection_tst() ;
+  open_bitstream_asynchrone_tst() ;
 }
 
 int premier_caractere()
@@ -353,3 +539,632 @@ void get_bit_tst()
 
 }
 
+
+void put_mot_tst()
+{
+  struct bitstream *s ;
+  int nb, i, c ;
+  FILE *f ;
+
+  /*
+   * Les bits posés par paquets doivent donner le même fichier
+   * que les bits posés un par un : l'octet i vaut i.
+   */
+  for(nb=1; nb<=NB_BITS_MAX; nb++)
+    {
+      s = open_bitstream("xxx", "w") ;
+      for(i=0; i<8*256; i+=nb)
+	{
+	  Buffer_Bit v = 0 ;
+	  for(c=i; c<i+nb && c<8*256; c++)
+	    v = 2*v + prend_bit(c/8, 7 - c%8) ;
+	  put_mot(s, c-i, v | ((Buffer_Bit)1 << (c-i))) ; /* Bit en trop */
+	}
+      close_bitstream(s) ;
+
+      f = fopen("xxx", "r") ;
+      for(c=0; c<256; c++)
+	if ( fgetc(f) != c )
+	  {
+	    eprintf("put_mot par paquets de %d bits\n", nb) ;
+	    eprintf("écrit mal l'octet %d dans le fichier\n", c) ;
+	    return ;
+	  }
+      if ( fgetc(f) != EOF )
+	{
+	  eprintf("put_mot par paquets de %d bits\n", nb) ;
+	  eprintf("écrit un octet de trop dans le fichier\n") ;
+	  return ;
+	}
+      fclose(f) ;
+    }
+
+  /*
+   * Une erreur d'écriture (disque plein) n'est pas perdue,
+   * elle est signalée au plus tard par "close_bitstream".
+   */
+  s = open_bitstream("/dev/full", "w") ;
+  nb = 0 ;
+  EXCEPTION(
+	    for(i=0; i<100000; i++)
+	      put_mot(s, 16, i) ;
+	    close_bitstream(s) ;
+	    ,
+	    ,
+	    case Exception_fichier_ecriture: nb = 1 ; break ;
+	    ) ;
+  if ( nb == 0 )
+    {
+      eprintf("put_mot dans \"/dev/full\" ne lance pas\n") ;
+      eprintf("l'exception Exception_fichier_ecriture\n") ;
+    }
+}
+
+void get_mot_tst()
+{
+  struct bitstream *s ;
+  int nb, i, c ;
+  Buffer_Bit v, attendu ;
+  volatile int t ;
+
+  put_mot_tst() ; /* L'octet i du fichier "xxx" vaut i */
+
+  for(nb=1; nb<=NB_BITS_MAX; nb++)
+    {
+      s = open_bitstream("xxx", "r") ;
+      for(i=0; i+nb<=8*256; i+=nb)
+	{
+	  attendu = 0 ;
+	  for(c=i; c<i+nb; c++)
+	    attendu = 2*attendu + prend_bit(c/8, 7 - c%8) ;
+	  v = get_mot(s, nb) ;
+	  if ( v != attendu )
+	    {
+	      eprintf("get_mot par paquets de %d bits\n", nb) ;
+	      eprintf("lit %lx au lieu de %lx\n", v, attendu) ;
+	      return ;
+	    }
+	}
+      t = 0 ;
+      EXCEPTION(get_mot(s, nb) ;
+		,
+		,
+		case Exception_fichier_lecture:
+		t = 1 ;
+		break ;
+		) ;
+      if ( t == 0 )
+	{
+	  eprintf("get_mot n'a pas lancé l'exception fin de fichier\n");
+	  return ;
+	}
+      close_bitstream(s) ;
+    }
+}
+
+void open_bitstream_memory_tst()
+{
+  struct bitstream *s ;
+  unsigned char *octets ;
+  size_t taille ;
+  int i, c ;
+  volatile int t ;
+
+  octets = NULL ;
+  taille = 0 ;
+  s = open_bitstream_memory(&octets, &taille, "w") ;
+  if ( bitstream_get_file(s) != NULL || !bitstream_en_ecriture(s) )
+    {
+      eprintf("Un flot en mémoire ouvert avec 'w' est mal initialisé\n") ;
+      return ;
+    }
+  close_bitstream(s) ;
+  if ( taille != 0 )
+    {
+      eprintf("Un flot en mémoire vide a une taille de %d\n", (int)taille) ;
+      return ;
+    }
+
+  /*
+   * Le tableau de l'appelant doit grandir (il commence à un octet)
+   */
+  taille = 1 ;
+  ALLOUER(octets, taille) ;
+  s = open_bitstream_memory(&octets, &taille, "w") ;
+  for(i=0; i<100; i++)
+    for(c=0; c<256; c++)
+      put_bits(s, 8, c) ;
+  put_bit(s, 1) ;
+  close_bitstream(s) ;
+  if ( taille != 100*256 + 1 )
+    {
+      eprintf("Le flot en mémoire fait %d octets au lieu de %d\n"
+	      , (int)taille, 100*256 + 1) ;
+      return ;
+    }
+  for(i=0; i<100*256; i++)
+    if ( octets[i] != i%256 )
+      {
+	eprintf("L'octet %d du flot en mémoire vaut %d\n", i, octets[i]) ;
+	return ;
+      }
+  if ( octets[i] != 128 )
+    {
+      eprintf("Le dernier bit du flot en mémoire est mal écrit\n") ;
+      return ;
+    }
+
+  /*
+   * Relecture sans copie
+   */
+  s = open_bitstream_memory(&octets, &taille, "r") ;
+  if ( bitstream_en_ecriture(s) || bitstream_nb_bits_dans_buffer(s) )
+    {
+      eprintf("Un flot en mémoire ouvert avec 'r' est mal initialisé\n") ;
+      return ;
+    }
+  for(i=0; i<100*256; i++)
+    if ( get_bits(s, 8) != i%256 )
+      {
+	eprintf("Mauvaise lecture de l'octet %d du flot en mémoire\n", i) ;
+	return ;
+      }
+  if ( get_bits(s, 8) != 128 )
+    {
+      eprintf("Mauvaise lecture du dernier octet du flot en mémoire\n") ;
+      return ;
+    }
+  t = 0 ;
+  EXCEPTION(get_bit(s) ;
+	    ,
+	    ,
+	    case Exception_fichier_lecture:
+	    t = 1 ;
+	    break ;
+	    ) ;
+  if ( t == 0 )
+    {
+      eprintf("Pas d'exception à la fin d'un flot en mémoire\n") ;
+      return ;
+    }
+  close_bitstream(s) ;
+
+  /*
+   * "taille" est la capacité à l'ouverture,
+   * puis le nombre d'octets écrits.
+   */
+  taille = 100*256 + 1 ;
+  s = open_bitstream_memory(&octets, &taille, "w") ;
+  if ( taille != 0 )
+    {
+      eprintf("La capacité n'est pas remise à 0 à l'ouverture\n") ;
+      return ;
+    }
+  put_bits(s, 8, 7) ;
+  flush_bitstream(s) ;
+  if ( taille != 1 || octets[0] != 7 )
+    {
+      eprintf("Flot en mémoire réutilisé : %d octets\n", (int)taille) ;
+      return ;
+    }
+  close_bitstream(s) ;
+  free(octets) ;
+}
+
+void open_bitstream_memory_read_tst()
+{
+  static const unsigned char octets[] = { 0x12, 0x34, 0xFF } ;
+  struct bitstream *s ;
+  volatile int t ;
+
+  s = open_bitstream_memory_read(octets, sizeof(octets)) ;
+  if ( bitstream_get_file(s) != NULL || bitstream_en_ecriture(s) )
+    {
+      eprintf("Un flot en mémoire constant est mal initialisé\n") ;
+      return ;
+    }
+  if ( get_bits(s, 12) != 0x123 || get_bits(s, 12) != 0x4FF )
+    {
+      eprintf("Mauvaise lecture d'un flot en mémoire constant\n") ;
+      return ;
+    }
+  t = 0 ;
+  EXCEPTION(get_bit(s) ;
+	    ,
+	    ,
+	    case Exception_fichier_lecture:
+	    t = 1 ;
+	    break ;
+	    ) ;
+  if ( t == 0 )
+    {
+      eprintf("Pas d'exception à la fin d'un flot en mémoire constant\n") ;
+      return ;
+    }
+  close_bitstream(s) ;
+
+  s = open_bitstream_memory_read(NULL, 0) ;
+  t = 0 ;
+  EXCEPTION(get_bit(s) ;
+	    ,
+	    ,
+	    case Exception_fichier_lecture:
+	    t = 1 ;
+	    break ;
+	    ) ;
+  if ( t == 0 )
+    {
+      eprintf("Pas d'exception sur un flot en mémoire vide\n") ;
+      return ;
+    }
+  close_bitstream(s) ;
+}
+
+void peek_mot_tst()
+{
+  struct bitstream *s ;
+  int nb, i ;
+
+  put_mot_tst() ; /* L'octet i du fichier "xxx" vaut i */
+
+  for(nb=1; nb<=NB_BITS_MAX; nb++)
+    {
+      s = open_bitstream("xxx", "r") ;
+      for(i=0; i<256; i++)
+	{
+	  if ( peek_mot(s, nb) != peek_mot(s, NB_BITS_MAX) >> (NB_BITS_MAX-nb) )
+	    {
+	      eprintf("peek_mot(%d) et peek_mot(%d) incohérents\n"
+		      , nb, NB_BITS_MAX) ;
+	      return ;
+	    }
+	  if ( peek_mot(s, 8) != i || get_mot(s, 8) != i )
+	    {
+	      eprintf("peek_mot ne doit pas consommer l'octet %d\n", i) ;
+	      return ;
+	    }
+	}
+      if ( peek_mot(s, nb) != 0 )
+	{
+	  eprintf("peek_mot après la fin du fichier doit voir des 0\n") ;
+	  return ;
+	}
+      close_bitstream(s) ;
+    }
+}
+
+void skip_mot_tst()
+{
+  struct bitstream *s ;
+  int nb, i, c ;
+  Buffer_Bit attendu ;
+  volatile int t ;
+
+  put_mot_tst() ; /* L'octet i du fichier "xxx" vaut i */
+
+  for(nb=1; nb<=NB_BITS_MAX; nb++)
+    {
+      s = open_bitstream("xxx", "r") ;
+      for(i=0; i+nb<=8*256; i+=nb)
+	skip_mot(s, nb) ;
+      attendu = 0 ;
+      for(c=i; c<8*256; c++)
+	attendu = 2*attendu + prend_bit(c/8, 7 - c%8) ;
+      if ( get_mot(s, 8*256-i) != attendu )
+	{
+	  eprintf("skip_mot de %d bits saute mal\n", nb) ;
+	  return ;
+	}
+      close_bitstream(s) ;
+
+      s = open_bitstream("xxx", "r") ;
+      for(i=0; i<255; i++)
+	skip_mot(s, 8) ;
+      t = 0 ;
+      EXCEPTION(skip_mot(s, 9) ;
+		,
+		,
+		case Exception_fichier_lecture:
+		t = 1 ;
+		break ;
+		) ;
+      if ( t == 0 || get_mot(s, 8) != 255 )
+	{
+	  eprintf("skip_mot après la fin du fichier doit lancer l'exception\n");
+	  eprintf("sans consommer de bits\n");
+	  return ;
+	}
+      close_bitstream(s) ;
+    }
+}
+
+void align_bitstream_tst()
+{
+  struct bitstream *s ;
+  FILE *f ;
+  int nb ;
+
+  /* En écriture : les bits de 0 à 8 suivis d'un octet 0xA5 */
+  s = open_bitstream("xxx", "w") ;
+  for(nb=0; nb<=8; nb++)
+    {
+      put_mot(s, nb, (1 << nb) - 1) ;
+      align_bitstream(s) ;
+      align_bitstream(s) ; /* Ne fait rien, c'est déjà cadré */
+      put_mot(s, 8, 0xA5) ;
+    }
+  close_bitstream(s) ;
+
+  f = fopen("xxx", "r") ;
+  for(nb=0; nb<=8; nb++)
+    {
+      if ( nb && fgetc(f) != (0xFF00 >> nb & 0xFF) )
+	{
+	  eprintf("align_bitstream n'ajoute pas des 0 après %d bits\n", nb) ;
+	  return ;
+	}
+      if ( fgetc(f) != 0xA5 )
+	{
+	  eprintf("align_bitstream cadre mal après %d bits\n", nb) ;
+	  return ;
+	}
+    }
+  if ( fgetc(f) != EOF )
+    {
+      eprintf("align_bitstream écrit des octets en trop\n") ;
+      return ;
+    }
+  fclose(f) ;
+
+  /* En lecture : on saute les bits de cadrage */
+  s = open_bitstream("xxx", "r") ;
+  for(nb=0; nb<=8; nb++)
+    {
+      if ( get_mot(s, nb) != (1 << nb) - 1 )
+	{
+	  eprintf("align_bitstream : lecture de %d bits fausse\n", nb) ;
+	  return ;
+	}
+      align_bitstream(s) ;
+      align_bitstream(s) ;
+      if ( get_mot(s, 8) != 0xA5 )
+	{
+	  eprintf("align_bitstream ne saute pas le cadrage après %d bits\n"
+		  , nb) ;
+	  return ;
+	}
+    }
+  close_bitstream(s) ;
+}
+
+/*
+ * Code dans un flot en mémoire le segment numéro "n" :
+ * "n" mots de "n" bits (le dernier octet est incomplet).
+ */
+
+static void code_segment(int n, unsigned char **octets, size_t *taille)
+{
+  struct bitstream *s ;
+  int i ;
+
+  *octets = NULL ;
+  *taille = 0 ;
+  s = open_bitstream_memory(octets, taille, "w") ;
+  for(i=0; i<n; i++)
+    put_mot(s, n, i * 12345) ;
+  close_bitstream(s) ;
+}
+
+/*
+ * Lit l'entête puis décode le segment numéro "n".
+ */
+
+static int decode_segment(struct bitstream *s, int n)
+{
+  int i ;
+
+  if ( get_marqueur_segment(s) != (size_t)(n*n + 7) / 8 )
+    return 0 ;
+  for(i=0; i<n; i++)
+    if ( get_mot(s, n) != ((Buffer_Bit)i * 12345 & (((Buffer_Bit)1<<n) - 1)) )
+      return 0 ;
+  return 1 ;
+}
+
+#define NB_SEGMENTS 40
+
+void put_octets_tst()
+{
+  struct bitstream *s ;
+  unsigned char *octets ;
+  size_t taille ;
+  int n ;
+
+  /*
+   * Segments codés séparément puis mis bout à bout,
+   * précédés d'un bit isolé qui oblige à cadrer.
+   */
+  s = open_bitstream("xxx", "w") ;
+  put_bit(s, 1) ;
+  for(n=1; n<NB_SEGMENTS; n++)
+    {
+      code_segment(n, &octets, &taille) ;
+      put_marqueur_segment(s, taille) ;
+      put_octets(s, octets, taille) ;
+      free(octets) ;
+    }
+  close_bitstream(s) ;
+
+  s = open_bitstream("xxx", "r") ;
+  if ( get_bit(s) != 1 )
+    {
+      eprintf("put_octets : le premier bit est perdu\n") ;
+      return ;
+    }
+  for(n=1; n<NB_SEGMENTS; n++)
+    if ( !decode_segment(s, n) )
+      {
+	eprintf("put_octets : le segment %d est mal recopié\n", n) ;
+	return ;
+      }
+  close_bitstream(s) ;
+}
+
+void get_octets_tst()
+{
+  struct bitstream *s ;
+  unsigned char *octets, *lus, dernier ;
+  size_t taille ;
+  int n ;
+  volatile int t ;
+
+  put_octets_tst() ;
+
+  /* On extrait les segments sans les décoder */
+  s = open_bitstream("xxx", "r") ;
+  get_bit(s) ;
+  for(n=1; n<NB_SEGMENTS; n++)
+    {
+      code_segment(n, &octets, &taille) ;
+      if ( get_marqueur_segment(s) != taille )
+	{
+	  eprintf("get_octets : la taille du segment %d est fausse\n", n) ;
+	  return ;
+	}
+      ALLOUER(lus, taille) ;
+      get_octets(s, lus, taille) ;
+      if ( memcmp(lus, octets, taille) )
+	{
+	  eprintf("get_octets : le segment %d est mal lu\n", n) ;
+	  return ;
+	}
+      free(lus) ;
+      free(octets) ;
+    }
+  t = 0 ;
+  EXCEPTION(get_octets(s, &dernier, 0) ; get_octets(s, &dernier, 1) ;
+	    ,
+	    ,
+	    case Exception_fichier_lecture:
+	    t = 1 ;
+	    break ;
+	    ) ;
+  if ( t == 0 )
+    {
+      eprintf("get_octets : pas d'exception en fin de fichier\n") ;
+      return ;
+    }
+  close_bitstream(s) ;
+}
+
+void put_marqueur_segment_tst()
+{
+  struct bitstream *s ;
+  unsigned char *octets ;
+  size_t taille ;
+  volatile int t ;
+
+  octets = NULL ;
+  taille = 0 ;
+  s = open_bitstream_memory(&octets, &taille, "w") ;
+  put_bit(s, 1) ;
+  put_marqueur_segment(s, 0x123456) ;
+  close_bitstream(s) ;
+  if ( taille != 7
+       || octets[0] != 0x80
+       || octets[1]*256 + octets[2] != MARQUEUR_SEGMENT
+       || octets[3] != 0 || octets[4] != 0x12
+       || octets[5] != 0x34 || octets[6] != 0x56 )
+    {
+      eprintf("put_marqueur_segment n'écrit pas l'entête cadré\n") ;
+      return ;
+    }
+
+  /* Sur un flot en lecture, le mode est testé avant de cadrer */
+  s = open_bitstream_memory(&octets, &taille, "r") ;
+  get_bit(s) ;
+  t = 0 ;
+  EXCEPTION(put_marqueur_segment(s, 1) ;
+	    ,
+	    ,
+	    case Exception_fichier_ecriture_dans_fichier_ouvert_en_lecture:
+	    t = 1 ;
+	    break ;
+	    ) ;
+  if ( t == 0 || bitstream_nb_bits_dans_buffer(s) % 8 != 7 )
+    {
+      eprintf("put_marqueur_segment en lecture : pas d'exception "
+	      "ou bits consommés\n") ;
+      return ;
+    }
+  close_bitstream(s) ;
+  free(octets) ;
+}
+
+void get_marqueur_segment_tst()
+{
+  struct bitstream *s ;
+  unsigned char *octets ;
+  size_t taille ;
+  int n ;
+  volatile int t ;
+
+  put_octets_tst() ;
+
+  /* Il manque le marqueur : le bit isolé du début */
+  s = open_bitstream("xxx", "r") ;
+  t = 0 ;
+  EXCEPTION(get_marqueur_segment(s) ;
+	    ,
+	    ,
+	    case Exception_marqueur_segment_absent:
+	    t = 1 ;
+	    break ;
+	    ) ;
+  if ( t == 0 )
+    {
+      eprintf("get_marqueur_segment ne détecte pas l'absence de marqueur\n") ;
+      return ;
+    }
+  close_bitstream(s) ;
+
+  /* On passe les segments sans les décoder grâce à leur taille */
+  s = open_bitstream("xxx", "r") ;
+  get_bit(s) ;
+  for(n=1; n<NB_SEGMENTS/2; n++)
+    {
+      taille = get_marqueur_segment(s) ;
+      ALLOUER(octets, taille) ;
+      get_octets(s, octets, taille) ;
+      free(octets) ;
+    }
+  if ( !decode_segment(s, NB_SEGMENTS/2) )
+    {
+      eprintf("get_marqueur_segment : reprise après les segments sautés "
+	      "impossible\n") ;
+      return ;
+    }
+  close_bitstream(s) ;
+
+  /* Sur un flot en écriture, le mode est testé avant de cadrer */
+  octets = NULL ;
+  taille = 0 ;
+  s = open_bitstream_memory(&octets, &taille, "w") ;
+  put_bit(s, 1) ;
+  t = 0 ;
+  EXCEPTION(get_marqueur_segment(s) ;
+	    ,
+	    ,
+	    case Exception_fichier_lecture_dans_fichier_ouvert_en_ecriture:
+	    t = 1 ;
+	    break ;
+	    ) ;
+  if ( t == 0 || bitstream_nb_bits_dans_buffer(s) != 1 )
+    {
+      eprintf("get_marqueur_segment en écriture : pas d'exception "
+	      "ou flot cadré\n") ;
+      return ;
+    }
+  close_bitstream(s) ;
+  free(octets) ;
+}
@@ -35,60 +35,133 @@
  *
  */
 
-static char *prefixes[] = { "00", "010", "011", "1000", "1001", "1010", "1011",
-			    "11000", "11001", "11010", "11011", "11100",
-			    "11101", "11110", "111110", "111111" } ;
+/*
+ * Les préfixes du tableau ci-dessus sous forme (code, nombre de bits)
+ * pour écrire le préfixe et le suffixe avec un seul "put_bits".
+ */
+
+static const struct
+{
+  unsigned char code ;
+  unsigned char longueur ;
+} prefixes[] = { {0, 2}, {2, 3}, {3, 3}, {8, 4}, {9, 4}, {10, 4}, {11, 4},
+		 {24, 5}, {25, 5}, {26, 5}, {27, 5}, {28, 5},
+		 {29, 5}, {30, 5}, {62, 6}, {63, 6} } ;
 
 void put_entier(struct bitstream *b, unsigned int f)
 {
 	unsigned int nbBitsUtile = nb_bits_utile(f);
+	unsigned int suffixe;
+
 	if (nbBitsUtile >= TAILLE(prefixes) ) 
 		EXIT;
 
-	//On put le préfixe
-	const char* prefixe = prefixes[nbBitsUtile];
-	put_bit_string(b, prefixe);
-
-	//On put le suffixe	
-	if (nbBitsUtile > 1)
-		put_bits(b, nbBitsUtile-1, f);
+	//Le suffixe est le nombre sans son premier bit à 1
+	suffixe = nbBitsUtile > 1 ? nbBitsUtile - 1 : 0;
+	put_bits(b, prefixes[nbBitsUtile].longueur + suffixe
+		 , (prefixes[nbBitsUtile].code << suffixe)
+		 | (f & ((1 << suffixe) - 1)));
 }
 
 /*
  * Cette fonction fait l'inverse de la précédente.
  *
- * Un implémentation propre, extensible serait d'utiliser
- * un arbre binaire comme pour le décodage d'Huffman.
- * Ou bien parcourir l'arbre des états 8 bits par 8 bits (voir le cours)
- * Mais je ne vous le demande pas
+ * On parcourt l'arbre des états 8 bits par 8 bits (voir le cours) :
+ * les 8 prochains bits du flot (sans les consommer) indexent une table
+ * qui donne directement le nombre si tout le code tient sur 8 bits
+ * (nombres de 0 à 31), sinon le préfixe, le suffixe restant à lire.
+ * Le plus long préfixe fait 6 bits, il tient toujours dans la table.
  */
 
-unsigned int get_entier(struct bitstream *b)
+#define DECODAGE_BITS 8
+
+/*
+ * La table ne dépend que de "prefixes", elle est donc écrite ici
+ * en constante (sans initialisation au premier appel) : elle peut
+ * servir en même temps à plusieurs fils d'exécution.
+ */
+
+static const struct
 {
+  unsigned short valeur ;	/* Le nombre ou le 1 de poids fort */
+  unsigned char  longueur ;	/* Nombre de bits décodés par la table */
+  unsigned char  suffixe ;	/* Nombre de bits restant à lire */
+} decodage[1 << DECODAGE_BITS] = {
+  {0, 2, 0}, {0, 2, 0}, {0, 2, 0}, {0, 2, 0},
+  {0, 2, 0}, {0, 2, 0}, {0, 2, 0}, {0, 2, 0},
+  {0, 2, 0}, {0, 2, 0}, {0, 2, 0}, {0, 2, 0},
+  {0, 2, 0}, {0, 2, 0}, {0, 2, 0}, {0, 2, 0},
+  {0, 2, 0}, {0, 2, 0}, {0, 2, 0}, {0, 2, 0},
+  {0, 2, 0}, {0, 2, 0}, {0, 2, 0}, {0, 2, 0},
+  {0, 2, 0}, {0, 2, 0}, {0, 2, 0}, {0, 2, 0},
+  {0, 2, 0}, {0, 2, 0}, {0, 2, 0}, {0, 2, 0},
+  {0, 2, 0}, {0, 2, 0}, {0, 2, 0}, {0, 2, 0},
+  {0, 2, 0}, {0, 2, 0}, {0, 2, 0}, {0, 2, 0},
+  {0, 2, 0}, {0, 2, 0}, {0, 2, 0}, {0, 2, 0},
+  {0, 2, 0}, {0, 2, 0}, {0, 2, 0}, {0, 2, 0},
+  {0, 2, 0}, {0, 2, 0}, {0, 2, 0}, {0, 2, 0},
+  {0, 2, 0}, {0, 2, 0}, {0, 2, 0}, {0, 2, 0},
+  {0, 2, 0}, {0, 2, 0}, {0, 2, 0}, {0, 2, 0},
+  {0, 2, 0}, {0, 2, 0}, {0, 2, 0}, {0, 2, 0},
+  {1, 3, 0}, {1, 3, 0}, {1, 3, 0}, {1, 3, 0},
+  {1, 3, 0}, {1, 3, 0}, {1, 3, 0}, {1, 3, 0},
+  {1, 3, 0}, {1, 3, 0}, {1, 3, 0}, {1, 3, 0},
+  {1, 3, 0}, {1, 3, 0}, {1, 3, 0}, {1, 3, 0},
+  {1, 3, 0}, {1, 3, 0}, {1, 3, 0}, {1, 3, 0},
+  {1, 3, 0}, {1, 3, 0}, {1, 3, 0}, {1, 3, 0},
+  {1, 3, 0}, {1, 3, 0}, {1, 3, 0}, {1, 3, 0},
+  {1, 3, 0}, {1, 3, 0}, {1, 3, 0}, {1, 3, 0},
+  {2, 4, 0}, {2, 4, 0}, {2, 4, 0}, {2, 4, 0},
+  {2, 4, 0}, {2, 4, 0}, {2, 4, 0}, {2, 4, 0},
+  {2, 4, 0}, {2, 4, 0}, {2, 4, 0}, {2, 4, 0},
+  {2, 4, 0}, {2, 4, 0}, {2, 4, 0}, {2, 4, 0},
+  {3, 4, 0}, {3, 4, 0}, {3, 4, 0}, {3, 4, 0},
+  {3, 4, 0}, {3, 4, 0}, {3, 4, 0}, {3, 4, 0},
+  {3, 4, 0}, {3, 4, 0}, {3, 4, 0}, {3, 4, 0},
+  {3, 4, 0}, {3, 4, 0}, {3, 4, 0}, {3, 4, 0},
+  {4, 6, 0}, {4, 6, 0}, {4, 6, 0}, {4, 6, 0},
+  {5, 6, 0}, {5, 6, 0}, {5, 6, 0}, {5, 6, 0},
+  {6, 6, 0}, {6, 6, 0}, {6, 6, 0}, {6, 6, 0},
+  {7, 6, 0}, {7, 6, 0}, {7, 6, 0}, {7, 6, 0},
+  {8, 7, 0}, {8, 7, 0}, {9, 7, 0}, {9, 7, 0},
+  {10, 7, 0}, {10, 7, 0}, {11, 7, 0}, {11, 7, 0},
+  {12, 7, 0}, {12, 7, 0}, {13, 7, 0}, {13, 7, 0},
+  {14, 7, 0}, {14, 7, 0}, {15, 7, 0}, {15, 7, 0},
+  {16, 8, 0}, {17, 8, 0}, {18, 8, 0}, {19, 8, 0},
+  {20, 8, 0}, {21, 8, 0}, {22, 8, 0}, {23, 8, 0},
+  {24, 8, 0}, {25, 8, 0}, {26, 8, 0}, {27, 8, 0},
+  {28, 8, 0}, {29, 8, 0}, {30, 8, 0}, {31, 8, 0},
+  {32, 4, 5}, {32, 4, 5}, {32, 4, 5}, {32, 4, 5},
+  {32, 4, 5}, {32, 4, 5}, {32, 4, 5}, {32, 4, 5},
+  {32, 4, 5}, {32, 4, 5}, {32, 4, 5}, {32, 4, 5},
+  {32, 4, 5}, {32, 4, 5}, {32, 4, 5}, {32, 4, 5},
+  {64, 5, 6}, {64, 5, 6}, {64, 5, 6}, {64, 5, 6},
+  {64, 5, 6}, {64, 5, 6}, {64, 5, 6}, {64, 5, 6},
+  {128, 5, 7}, {128, 5, 7}, {128, 5, 7}, {128, 5, 7},
+  {128, 5, 7}, {128, 5, 7}, {128, 5, 7}, {128, 5, 7},
+  {256, 5, 8}, {256, 5, 8}, {256, 5, 8}, {256, 5, 8},
+  {256, 5, 8}, {256, 5, 8}, {256, 5, 8}, {256, 5, 8},
+  {512, 5, 9}, {512, 5, 9}, {512, 5, 9}, {512, 5, 9},
+  {512, 5, 9}, {512, 5, 9}, {512, 5, 9}, {512, 5, 9},
+  {1024, 5, 10}, {1024, 5, 10}, {1024, 5, 10}, {1024, 5, 10},
+  {1024, 5, 10}, {1024, 5, 10}, {1024, 5, 10}, {1024, 5, 10},
+  {2048, 5, 11}, {2048, 5, 11}, {2048, 5, 11}, {2048, 5, 11},
+  {2048, 5, 11}, {2048, 5, 11}, {2048, 5, 11}, {2048, 5, 11},
+  {4096, 5, 12}, {4096, 5, 12}, {4096, 5, 12}, {4096, 5, 12},
+  {4096, 5, 12}, {4096, 5, 12}, {4096, 5, 12}, {4096, 5, 12},
+  {8192, 6, 13}, {8192, 6, 13}, {8192, 6, 13}, {8192, 6, 13},
+  {16384, 6, 14}, {16384, 6, 14}, {16384, 6, 14}, {16384, 6, 14}
+} ;
 
-	//Surement mauvais....
-	//On lit e = 2 bits, puis on lira e bits
-	//Si e est à la valeur max (en ayant lu 3 bits....) on relit 1 bit
-	//Variable en dur => c'est moche
-	//Trouver une logique ? Pourquoi 6 bits au max dans le suffixe?
-
-	//unsigned int maxValue = pow2(2) - 1;
-	
-	unsigned int beginPrefixe = get_bits(b, 2);
-	unsigned int endPrefixe = get_bits(b,beginPrefixe);
-	unsigned int indexPrefixe = (pow2(beginPrefixe) - 1) + endPrefixe;
-	//Max value = 2**3-1
-	if (endPrefixe == 7) {
-		//On doit relire 1 bit..
-		indexPrefixe += get_bit(b);
-	}
+unsigned int get_entier(struct bitstream *b)
+{
+	unsigned int i;
 
-	//On connait le préfixe, à l'indice indexPrefixe
-	//On doit lire indexPrefixe-1 valeur après le préfixe
-	if (indexPrefixe <= 1) return indexPrefixe;
-	int nbBitsALire = indexPrefixe - 1;
-	//On ajoute un 1 au poids fort
-	return get_bits(b, nbBitsALire) + pow2(nbBitsALire);
+	i = peek_bits(b, DECODAGE_BITS);
+	skip_bits(b, decodage[i].longueur);
+	if (decodage[i].suffixe == 0)
+		return decodage[i].valeur;
+	return decodage[i].valeur + get_bits(b, decodage[i].suffixe);
 }
 
 /*
@@ -129,3 +202,32 @@ int get_entier_signe(struct bitstream *b)
 	//else, entier négatif
 	return -get_entier(b)-1;
 }
+
+/*
+ * Exp-Golomb d'ordre 0, pour les entiers sans limite de taille
+ * (les entêtes des codeurs par blocs) : "v+1" précédé d'autant
+ * de 0 que son nombre de bits utiles moins un.
+ *    0 --> 1
+ *    1 --> 010
+ *    2 --> 011
+ *    3 --> 00100
+ */
+
+void put_exp_golomb(struct bitstream *b, unsigned int v)
+{
+	unsigned long w = (unsigned long)v + 1;
+	unsigned int nb = nb_bits_utile(w);
+
+	put_bits(b, nb - 1, 0);
+	put_bits(b, nb, w);
+}
+
+unsigned int get_exp_golomb(struct bitstream *b)
+{
+	unsigned int nb = 0;
+
+	while (!get_bit(b))
+		if (++nb > 32)
+			EXIT;
+	return ((1ul << nb) | get_bits(b, nb)) - 1;
+}
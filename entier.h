@@ -13,4 +13,7 @@ unsigned int get_entier(struct bitstream*) ;
 void put_entier_signe(struct bitstream*, int) ;
 int get_entier_signe(struct bitstream*) ;
 
+void put_exp_golomb(struct bitstream*, unsigned int) ;
+unsigned int get_exp_golomb(struct bitstream*) ;
+
 #endif
@@ -1,5 +1,6 @@
 #include "entier.h"
 #include "bases.h"
+#include "bits.h"
 
 static struct
 {
@@ -66,6 +67,8 @@ void get_entier_tst()
 {
   int i, j ;
   struct bitstream *bs ;
+  unsigned char *octets ;
+  size_t taille ;
 
   put_entier_tst() ;
 
@@ -82,6 +85,23 @@ void get_entier_tst()
 	  }
     }
   close_bitstream(bs) ;
+
+  /* Tous les entiers codables, dans un flot en mémoire */
+  octets = NULL ;
+  taille = 0 ;
+  bs = open_bitstream_memory(&octets, &taille, "w") ;
+  for(i=0; i<32768; i++)
+    put_entier(bs, i) ;
+  close_bitstream(bs) ;
+  bs = open_bitstream_memory(&octets, &taille, "r") ;
+  for(i=0; i<32768; i++)
+    if ( (j = get_entier(bs)) != i )
+      {
+	eprintf("Lecture de l'entier %d, je recois %d\n", i, j) ;
+	return ;
+      }
+  close_bitstream(bs) ;
+  free(octets) ;
 }
 
 void put_entier_signe_tst()
@@ -170,3 +190,56 @@ void get_entier_signe_tst()
     }
   close_bitstream(bs) ;
 }
+
+static const unsigned int exp_golomb[] = { 0, 1, 2, 3, 7, 100, 32767, 65536
+					   , 0x7fffffff, 0xfffffffe, 0xffffffff } ;
+
+void put_exp_golomb_tst()
+{
+  struct bitstream *bs, *ref ;
+  unsigned char *octets = NULL, *octets_ref = NULL ;
+  size_t taille = 0, taille_ref = 0 ;
+
+  bs = open_bitstream_memory(&octets, &taille, "w") ;
+  put_exp_golomb(bs, 0) ;
+  put_exp_golomb(bs, 1) ;
+  put_exp_golomb(bs, 2) ;
+  put_exp_golomb(bs, 3) ;
+  put_exp_golomb(bs, 13) ;
+  close_bitstream(bs) ;
+
+  ref = open_bitstream_memory(&octets_ref, &taille_ref, "w") ;
+  put_bit_string(ref, "1" "010" "011" "00100" "0001110") ;
+  close_bitstream(ref) ;
+
+  if ( taille != taille_ref || memcmp(octets, octets_ref, taille) )
+    {
+      eprintf("Le code de Exp-Golomb n'est pas le bon\n") ;
+      return ;
+    }
+  free(octets) ;
+  free(octets_ref) ;
+}
+
+void get_exp_golomb_tst()
+{
+  struct bitstream *bs ;
+  unsigned char *octets = NULL ;
+  size_t taille = 0 ;
+  int i ;
+
+  bs = open_bitstream_memory(&octets, &taille, "w") ;
+  for(i=0; i<TAILLE(exp_golomb); i++)
+    put_exp_golomb(bs, exp_golomb[i]) ;
+  close_bitstream(bs) ;
+
+  bs = open_bitstream_memory(&octets, &taille, "r") ;
+  for(i=0; i<TAILLE(exp_golomb); i++)
+    if ( get_exp_golomb(bs) != exp_golomb[i] )
+      {
+	eprintf("Mauvaise lecture de %u\n", exp_golomb[i]) ;
+	return ;
+      }
+  close_bitstream(bs) ;
+  free(octets) ;
+}
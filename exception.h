@@ -9,7 +9,12 @@
 #include <setjmp.h>
 #include <stdlib.h>
 
-extern volatile struct exception_c
+/*
+ * La pile des exceptions est propre à chaque fil d'exécution :
+ * un fil ne peut lancer une exception que dans un de ses "EXCEPTION".
+ */
+
+extern __thread volatile struct exception_c
 {
   int profondeur ;
   int profondeur_max ;
@@ -21,7 +26,7 @@ extern volatile struct exception_c
  * Le programme principal doit déclarer le système d'exception
  */
 
-#define EXCEPTION_DECLARATION volatile struct exception_c global_exception = { 0 }
+#define EXCEPTION_DECLARATION __thread volatile struct exception_c global_exception = { 0 }
 
 /*
  * Lancer une exception pour indiquer un problème
@@ -88,6 +93,7 @@ enum {
   Exception_fichier_ecriture_dans_fichier_ouvert_en_lecture,
   Exception_fichier_lecture_dans_fichier_ouvert_en_ecriture,
   Exception_arbre_shannon_fano_invalide,
+  Exception_marqueur_segment_absent,
 
   Exception_derniere
 } ;
@@ -1,4 +1,5 @@
 #include <string.h>
+#include <limits.h>
 #include "bases.h"
 #include "matrice.h"
 #include "dct.h"
@@ -11,6 +12,10 @@
 #include "bitstream.h"
 #include "exception.h"
 #include "ondelette.h"
+#include "bits.h"
+#include "bit.h"
+#include <time.h>
+#include <pthread.h>
 
 #define LARG 8 /* 8 blocs à afficher */
 
@@ -25,6 +30,14 @@ struct parametres
   float qualite ;
   int shannon ;
   int saute_entete ;
+  int asynchrone ;
+  int fenetre ;
+  int rice ;
+  int contextes ;
+  char *modele ;
+  char *sauve_modele ;
+  int tranches ;
+  int joint ;
 } ;
 
 void fread_safe(void *ptr, size_t size, size_t nr, FILE *f)
@@ -149,72 +162,521 @@ void saute_entete(struct parametres *p)
     }
 }
 
+/*
+ * SHANNON=1 : Shannon-Fano adaptatif (le code change à chaque valeur)
+ * SHANNON=2 : le code n'est recalculé que toutes les FENETRE valeurs
+ * SHANNON=3 : Huffman canonique en deux passes (un seul "intstream")
+ * SHANNON=4 : codage par intervalles adaptatif (un seul "intstream")
+ * SHANNON=5 : rANS statique entrelacé (un seul "intstream")
+ */
+#define FENETRE_DEFAUT 4096
+
+/*
+ * Nombre de valeurs codées avec le même code, 0 si adaptatif.
+ */
+static int fenetre_shannon_fano(struct parametres *p)
+{
+  if ( p->shannon == 2 )
+    return p->fenetre ? p->fenetre : FENETRE_DEFAUT ;
+  return 0 ;
+}
+
+/*
+ * Si "modele" n'est pas NULL, le modèle commence avec la table
+ * qui y est lue (voir "open_shannon_fano_modele").
+ */
+static struct shannon_fano* ouvre_shannon_fano(struct parametres *p
+					       , struct bitstream *modele)
+{
+  int fenetre ;
+
+  fenetre = fenetre_shannon_fano(p) ;
+  if ( modele )
+    return open_shannon_fano_modele(modele, fenetre) ;
+  if ( fenetre )
+    return open_shannon_fano_fenetre(fenetre) ;
+  return open_shannon_fano() ;
+}
+
+static enum intstream_type type_intstream(struct parametres *p)
+{
+  switch(p->shannon)
+    {
+    case 3: return Huffman ;
+    case 4: return Intervalle ;
+    case 5: return Rans ;
+    default: return Shannon_fano ;
+    }
+}
+
+/*
+ * Les "intstream" de la RLE.
+ * RICE=1 : les longueurs des suites de 0 sont codées par
+ * Golomb-Rice adaptatif (avec SHANNON=0, 1 ou 2 seulement).
+ *
+ * Avec SHANNON=1 ou 2, CONTEXTES choisit les modèles Shannon-Fano :
+ * CONTEXTES=0 : un seul modèle pour les longueurs et les valeurs
+ *               (par défaut, c'est le format d'origine)
+ * CONTEXTES=1 : un modèle pour les longueurs et un pour les valeurs
+ * CONTEXTES=2 : de plus, un couple de modèles par bande de fréquence,
+ *               la bande est le nombre de bits de la position
+ *               dans le bloc (qui est parcouru en zigzag).
+ * Les autres types n'ont qu'un "intstream" et ignorent CONTEXTES.
+ *
+ * SAUVE_MODELE=fichier : y écrit les modèles Shannon-Fano à la fin
+ *                        (ceux de "rle" et de "rleinv" sont les mêmes).
+ * MODELE=fichier : "rle" et "rleinv" partent de ces modèles
+ *                  au lieu de modèles vides (mêmes SHANNON et CONTEXTES).
+ *
+ * JOINT=1 (avec SHANNON=1 ou 2) : la longueur de la suite de 0 et
+ * la catégorie de la valeur qui la suit sont un seul symbole
+ * (voir "compresse_joint"), un modèle par bande, RICE est ignoré.
+ */
+
+struct contextes
+{
+  int nb ;			/* Nombre de bandes */
+  int *bande ;			/* Bande de chaque position, ou NULL */
+  struct intstream **entier ;
+  struct intstream **entier_signe ;
+  struct shannon_fano **sf ;	/* Les modèles à fermer */
+  int nb_sf ;
+  int joint ;			/* Les symboles sont dans "entier" */
+  struct bitstream *bitstream ;
+} ;
+
+static void ouvre_intstreams(struct parametres *p, struct bitstream *bs
+			     , struct contextes *c)
+{
+  struct bitstream *modele ;
+  int i ;
+
+  c->nb = 1 ;
+  c->bande = NULL ;
+  c->bitstream = bs ;
+  c->joint = p->joint && (p->shannon == 1 || p->shannon == 2) ;
+  if ( p->shannon == 1 || p->shannon == 2 )
+    {
+      if ( p->contextes >= 2 )
+	{
+	  ALLOUER(c->bande, p->nbe) ;
+	  for(i=0; i<p->nbe; i++)
+	    c->bande[i] = nb_bits_utile(i) ;
+	  c->nb = c->bande[p->nbe-1] + 1 ;
+	}
+      c->nb_sf = p->contextes ? 2 * c->nb : 1 ;
+      if ( c->joint )
+	c->nb_sf = c->nb ;
+    }
+  else
+    c->nb_sf = 0 ;
+
+  ALLOUER(c->entier, c->nb) ;
+  ALLOUER(c->entier_signe, c->nb) ;
+  ALLOUER(c->sf, c->nb_sf + 1) ;
+  modele = NULL ;
+  if ( p->modele && c->nb_sf )
+    {
+      modele = open_bitstream(p->modele, "r") ;
+      if ( get_bits(modele, sizeof(int) * 8) != c->nb_sf )
+	{
+	  fprintf(stderr, "%s n'a pas été fait avec ces SHANNON et CONTEXTES\n"
+		  , p->modele) ;
+	  EXIT ;
+	}
+    }
+  for(i=0; i<c->nb_sf; i++)
+    c->sf[i] = ouvre_shannon_fano(p, modele) ;
+  if ( modele )
+    close_bitstream(modele) ;
+
+  for(i=0; i<c->nb; i++)
+    if ( p->shannon >= 3 )
+      c->entier[i] = c->entier_signe[i]
+	= open_intstream(bs, type_intstream(p), NULL) ;
+    else if ( c->joint )
+      c->entier[i] = c->entier_signe[i]
+	= open_intstream(bs, Shannon_fano, c->sf[i]) ;
+    else if ( p->shannon )
+      {
+	c->entier[i] = p->rice ? open_intstream(bs, Rice, NULL)
+	  : open_intstream(bs, Shannon_fano, c->sf[(2*i) % c->nb_sf]) ;
+	c->entier_signe[i] = open_intstream(bs, Shannon_fano
+					    , c->sf[(2*i+1) % c->nb_sf]) ;
+      }
+    else
+      {
+	c->entier[i] = open_intstream(bs, p->rice ? Rice : Entier, NULL) ;
+	c->entier_signe[i] = open_intstream(bs, Entier_Signe, NULL) ;
+      }
+}
+
+static void ferme_intstreams(struct parametres *p, struct contextes *c)
+{
+  struct bitstream *modele ;
+  int i ;
+
+  for(i=0; i<c->nb; i++)
+    {
+      close_intstream(c->entier[i]) ;
+      if ( c->entier_signe[i] != c->entier[i] )
+	close_intstream(c->entier_signe[i]) ;
+    }
+  if ( p->sauve_modele && c->nb_sf )
+    {
+      modele = open_bitstream(p->sauve_modele, "w") ;
+      put_bits(modele, sizeof(int) * 8, c->nb_sf) ;
+      for(i=0; i<c->nb_sf; i++)
+	sauve_shannon_fano(modele, c->sf[i]) ;
+      close_bitstream(modele) ;
+    }
+  for(i=0; i<c->nb_sf; i++)
+    close_shannon_fano(c->sf[i]) ;
+  free(c->entier) ;
+  free(c->entier_signe) ;
+  free(c->sf) ;
+  free(c->bande) ;
+}
+
+/*
+ * Un bloc de la RLE avec un ou plusieurs contextes.
+ */
+
+static void compresse_contextes(struct contextes *c, int nbe, const float *t)
+{
+  if ( c->joint )
+    compresse_joint(c->entier, c->bitstream, c->bande, nbe, t) ;
+  else if ( c->bande )
+    compresse_bandes(c->entier, c->entier_signe, c->bande, nbe, t) ;
+  else
+    compresse(c->entier[0], c->entier_signe[0], nbe, t) ;
+}
+
+static void decompresse_contextes(struct contextes *c, int nbe, float *t)
+{
+  if ( c->joint )
+    decompresse_joint(c->entier, c->bitstream, c->bande, nbe, t) ;
+  else if ( c->bande )
+    decompresse_bandes(c->entier, c->entier_signe, c->bande, nbe, t) ;
+  else
+    decompresse(c->entier[0], c->entier_signe[0], nbe, t) ;
+}
+
+/*
+ * TRANCHES=N : les blocs sont partagés en N tranches consécutives
+ * codées en parallèle (un fil d'exécution par tranche), chacune avec
+ * ses propres modèles dans son propre segment en mémoire.
+ * Le flot commence par N puis, pour chaque tranche, son nombre
+ * de blocs et la taille de son segment en octets ; les segments suivent.
+ * Le décodeur lit N dans le flot (TRANCHES doit seulement être non nul).
+ * SAUVE_MODELE est ignoré car il y a un jeu de modèles par tranche.
+ *
+ * Chaque fil récupère ses propres exceptions (la pile des exceptions
+ * est propre au fil) et les note dans "erreur" : elles sont signalées
+ * après "pthread_join". L'entête lu est vérifié avant toute allocation.
+ */
+
+#define TRANCHES_MAX 1024
+/* Taille maximale d'un segment : octets par valeur et entête (modèles) */
+#define OCTETS_PAR_VALEUR_MAX 16
+#define OCTETS_ENTETE_MAX     65536
+
+struct tranche
+{
+  struct parametres *p ;
+  float *blocs ;		/* Les "nb_blocs" blocs de la tranche */
+  int nb_blocs ;
+  unsigned char *octets ;	/* Le segment codé */
+  size_t taille ;
+  void (*fct)(struct tranche *t) ;
+  int erreur ;			/* Exception de la tranche ou 0 */
+  pthread_t fil ;
+} ;
+
+static void code_tranche(struct tranche *t)
+{
+  struct contextes c ;
+  struct bitstream *bs ;
+  int i ;
+
+  t->octets = NULL ;
+  t->taille = 0 ;
+  bs = open_bitstream_memory(&t->octets, &t->taille, "w") ;
+  ouvre_intstreams(t->p, bs, &c) ;
+  for(i=0; i<t->nb_blocs; i++)
+    compresse_contextes(&c, t->p->nbe, t->blocs + i * t->p->nbe) ;
+  ferme_intstreams(t->p, &c) ;
+  close_bitstream(bs) ;
+}
+
+static void decode_tranche(struct tranche *t)
+{
+  struct contextes c ;
+  struct bitstream *bs ;
+  int i ;
+
+  bs = open_bitstream_memory_read(t->octets, t->taille) ;
+  ouvre_intstreams(t->p, bs, &c) ;
+  for(i=0; i<t->nb_blocs; i++)
+    decompresse_contextes(&c, t->p->nbe, t->blocs + i * t->p->nbe) ;
+  ferme_intstreams(t->p, &c) ;
+  close_bitstream(bs) ;
+}
+
+/*
+ * Le fil d'exécution d'une tranche : une exception (segment corrompu,
+ * tronqué...) arrête la tranche et est notée dans "erreur".
+ */
+
+static void* fil_tranche(void *a)
+{
+  struct tranche *t = a ;
+
+  t->erreur = 0 ;
+  EXCEPTION(t->fct(t) ;
+	    ,
+	    t->erreur = global_exception.valeur_de_retour ;
+	    ,
+	    case Exception_fichier_ouverture: break ;
+	    case Exception_fichier_lecture: break ;
+	    case Exception_arbre_shannon_fano_invalide: break ;
+	    ) ;
+  free(global_exception.buf) ;
+  return NULL ;
+}
+
+/*
+ * Lance "fct" sur chaque tranche dans son fil d'exécution,
+ * attend qu'elles soient toutes finies puis signale les erreurs.
+ */
+
+static void lance_tranches(struct tranche *t, int nb
+			   , void (*fct)(struct tranche *t))
+{
+  int i ;
+
+  for(i=0; i<nb; i++)
+    {
+      t[i].fct = fct ;
+      if ( pthread_create(&t[i].fil, NULL, fil_tranche, &t[i]) )
+	{
+	  perror("pthread_create") ;
+	  EXIT ;
+	}
+    }
+  for(i=0; i<nb; i++)
+    pthread_join(t[i].fil, NULL) ;
+  for(i=0; i<nb; i++)
+    if ( t[i].erreur )
+      {
+	fprintf(stderr, "Tranche %d : exception %d\n", i, t[i].erreur) ;
+	EXIT ;
+      }
+}
+
+static void filtre_rle_tranches(struct parametres *p)
+{
+  float *blocs ;
+  int nb_blocs, capacite, i ;
+  struct tranche *t ;
+  struct bitstream *bs ;
+
+  if ( p->tranches > TRANCHES_MAX )
+    {
+      fprintf(stderr, "Au plus %d tranches\n", TRANCHES_MAX) ;
+      EXIT ;
+    }
+  capacite = 1024 ;
+  ALLOUER(blocs, capacite * p->nbe) ;
+  nb_blocs = 0 ;
+  while( fread((char*)(blocs + nb_blocs * p->nbe), 1, p->nbe*sizeof(*blocs)
+	       , stdin) == p->nbe*sizeof(*blocs) )
+    if ( ++nb_blocs == capacite )
+      {
+	capacite *= 2 ;
+	blocs = realloc(blocs, capacite * p->nbe * sizeof(*blocs)) ;
+	if ( blocs == NULL )
+	  {
+	    fprintf(stderr, "Plus de memoire\n") ;
+	    EXIT ;
+	  }
+      }
+
+  p->sauve_modele = NULL ;
+  ALLOUER(t, p->tranches) ;
+  for(i=0; i<p->tranches; i++)
+    {
+      t[i].p = p ;
+      t[i].blocs = blocs + (long)nb_blocs * i / p->tranches * p->nbe ;
+      t[i].nb_blocs = (long)nb_blocs * (i+1) / p->tranches
+	- (long)nb_blocs * i / p->tranches ;
+    }
+  lance_tranches(t, p->tranches, code_tranche) ;
+
+  for(i=0; i<p->tranches; i++)
+    if ( t[i].taille > 0xFFFFFFFFu )
+      {
+	fprintf(stderr, "Tranche %d : segment de plus de 4 Go\n", i) ;
+	EXIT ;
+      }
+  bs = open_bitstream("-", p->asynchrone ? "w&" : "w") ;
+  put_bits(bs, sizeof(int) * 8, p->tranches) ;
+  for(i=0; i<p->tranches; i++)
+    {
+      put_bits(bs, sizeof(int) * 8, t[i].nb_blocs) ;
+      put_bits(bs, sizeof(int) * 8, t[i].taille) ;
+    }
+  for(i=0; i<p->tranches; i++)
+    {
+      put_octets(bs, t[i].octets, t[i].taille) ;
+      free(t[i].octets) ;
+    }
+  close_bitstream(bs) ;
+  free(t) ;
+  free(blocs) ;
+}
+
+/*
+ * Lit l'entête et les segments des tranches.
+ * Des valeurs hors des bornes arrêtent le programme,
+ * un flot tronqué lance l'exception Exception_fichier_lecture.
+ */
+
+static struct tranche *lit_tranches(struct parametres *p, struct bitstream *bs
+				    , int *nb_tranches, float **blocs)
+{
+  unsigned long nb, taille ;
+  int nb_blocs, i ;
+  struct tranche *t ;
+
+  nb = get_bits(bs, sizeof(int) * 8) ;
+  if ( nb == 0 || nb > TRANCHES_MAX )
+    {
+      fprintf(stderr, "Flot invalide : %lu tranches\n", nb) ;
+      EXIT ;
+    }
+  *nb_tranches = nb ;
+  ALLOUER(t, *nb_tranches) ;
+  nb_blocs = 0 ;
+  for(i=0; i<*nb_tranches; i++)
+    {
+      nb = get_bits(bs, sizeof(int) * 8) ;
+      taille = get_bits(bs, sizeof(int) * 8) ;
+      if ( nb > (unsigned long)(INT_MAX / p->nbe - nb_blocs)
+	   || taille > nb * p->nbe * OCTETS_PAR_VALEUR_MAX + OCTETS_ENTETE_MAX )
+	{
+	  fprintf(stderr, "Flot invalide : tranche %d de %lu blocs"
+		  " et %lu octets\n", i, nb, taille) ;
+	  EXIT ;
+	}
+      t[i].p = p ;
+      t[i].nb_blocs = nb ;
+      t[i].taille = taille ;
+      nb_blocs += nb ;
+    }
+  ALLOUER(*blocs, (long)nb_blocs * p->nbe) ;
+  nb_blocs = 0 ;
+  for(i=0; i<*nb_tranches; i++)
+    {
+      t[i].blocs = *blocs + (long)nb_blocs * p->nbe ;
+      nb_blocs += t[i].nb_blocs ;
+      t[i].octets = NULL ;
+    }
+  for(i=0; i<*nb_tranches; i++)
+    {
+      ALLOUER(t[i].octets, t[i].taille) ;
+      get_octets(bs, t[i].octets, t[i].taille) ;
+    }
+  return t ;
+}
+
+static void filtre_rleinv_tranches(struct parametres *p)
+{
+  float *blocs ;
+  int nb_tranches, nb_blocs, i ;
+  struct tranche *t ;
+  struct bitstream *bs ;
+
+  t = NULL ;
+  blocs = NULL ;
+  nb_tranches = 0 ;
+  bs = open_bitstream("-", p->asynchrone ? "rm&" : "rm") ;
+  EXCEPTION(t = lit_tranches(p, bs, &nb_tranches, &blocs) ;
+	    ,
+	    ,
+	    case Exception_fichier_lecture:
+	    fprintf(stderr, "Flot de tranches tronqué\n") ;
+	    EXIT ;
+	    ) ;
+  close_bitstream(bs) ;
+
+  lance_tranches(t, nb_tranches, decode_tranche) ;
+
+  nb_blocs = 0 ;
+  for(i=0; i<nb_tranches; i++)
+    nb_blocs += t[i].nb_blocs ;
+  fwrite(blocs, p->nbe * sizeof(*blocs), nb_blocs, stdout) ;
+  for(i=0; i<nb_tranches; i++)
+    free(t[i].octets) ;
+  free(t) ;
+  free(blocs) ;
+}
+
 void filtre_rle(struct parametres *p)
 {
   float *entree ;
-  struct intstream *entier, *entier_signe ;
+  struct contextes c ;
   struct bitstream *bs ;
-  struct shannon_fano *sf ;
 
   if ( p->saute_entete )
     p->nbe *= p->nbe ;
 
   saute_entete(p) ;
-  bs = open_bitstream("-", "w") ;
-  if ( p->shannon )
-    {
-      sf = open_shannon_fano() ;
-      entier = open_intstream(bs, Shannon_fano, sf) ;
-      entier_signe = open_intstream(bs, Shannon_fano, sf) ;
-    }
-  else
+  if ( p->tranches > 0 )
     {
-      entier = open_intstream(bs, Entier, NULL) ;
-      entier_signe = open_intstream(bs, Entier_Signe, NULL) ;
+      filtre_rle_tranches(p) ;
+      return ;
     }
+  bs = open_bitstream("-", p->asynchrone ? "w&" : "w") ;
+  ouvre_intstreams(p, bs, &c) ;
 
   ALLOUER(entree, p->nbe) ;
 
   while( fread((char*)entree,1,p->nbe*sizeof(*entree),stdin) == p->nbe*sizeof(*entree) )
     {
-      compresse(entier, entier_signe, p->nbe, entree) ;
+      compresse_contextes(&c, p->nbe, entree) ;
     } 
+  if ( c.joint )
+    termine_joint(c.entier, c.bande) ;
   free(entree) ;
-  close_intstream(entier) ;
-  close_intstream(entier_signe) ;
+  ferme_intstreams(p, &c) ;
   close_bitstream(bs) ;
 }
 
 void filtre_rleinv(struct parametres *p)
 {
   float *entree ;
-  struct intstream *entier, *entier_signe ;
+  struct contextes c ;
   struct bitstream *bs ;
-  struct shannon_fano *sf ;
 
   if ( p->saute_entete )
     p->nbe *= p->nbe ;
 
   saute_entete(p) ;
-  bs = open_bitstream("-", "r") ;
-  if ( p->shannon )
+  if ( p->tranches > 0 )
     {
-      sf = open_shannon_fano() ;
-      entier = open_intstream(bs, Shannon_fano, sf) ;
-      entier_signe = open_intstream(bs, Shannon_fano, sf) ;
-    }
-  else
-    {
-      entier = open_intstream(bs, Entier, NULL) ;
-      entier_signe = open_intstream(bs, Entier_Signe, NULL) ;
+      filtre_rleinv_tranches(p) ;
+      return ;
     }
+  bs = open_bitstream("-", p->asynchrone ? "rm&" : "rm") ;
+  ouvre_intstreams(p, bs, &c) ;
  
   ALLOUER(entree, p->nbe) ;
   EXCEPTION(
   {
     for(;;)
       {
-	decompresse(entier, entier_signe, p->nbe, entree) ;
+	decompresse_contextes(&c, p->nbe, entree) ;
 	fwrite(entree, p->nbe, sizeof(*entree), stdout) ;
       }
   }
@@ -226,8 +688,7 @@ void filtre_rleinv(struct parametres *p)
   ) ;
 
   free(entree) ;
-  close_intstream(entier) ;
-  close_intstream(entier_signe) ;
+  ferme_intstreams(p, &c) ;
   close_bitstream(bs) ;
 }
 
@@ -262,7 +723,7 @@ void filtre_shannon_fano_8(struct parametres *p)
   int c ;
 
   sf = open_shannon_fano() ;
-  bs = open_bitstream("-", "w") ;
+  bs = open_bitstream("-", p->asynchrone ? "w&" : "w") ;
 
   for(;;)
     {
@@ -282,7 +743,7 @@ void filtre_shannon_fano_16(struct parametres *p)
   int c, d ;
 
   sf = open_shannon_fano() ;
-  bs = open_bitstream("-", "w") ;
+  bs = open_bitstream("-", p->asynchrone ? "w&" : "w") ;
 
   for(;;)
     {
@@ -419,14 +880,95 @@ void filtre_zigzaginv(struct parametres *p)
     }
 }
 
+static void parametres_ondelette(struct parametres *p
+				 , struct parametres_ondelette *po)
+{
+  po->type = type_intstream(p) ;
+  po->fenetre = fenetre_shannon_fano(p) ;
+  po->contextes = p->contextes ;
+}
+
 void filtre_ondelette(struct parametres *p)
 {
-   ondelette_encode_image(p->qualite) ;
+  struct parametres_ondelette po ;
+
+  parametres_ondelette(p, &po) ;
+  ondelette_encode_image(p->qualite, &po) ;
 }
 
 void filtre_ondeletteinv(struct parametres *p)
 {
-   ondelette_decode_image() ;
+  struct parametres_ondelette po ;
+
+  parametres_ondelette(p, &po) ;
+  ondelette_decode_image(&po) ;
+}
+
+/*
+ * Mesure du débit du flot de bits (en millions de bits par seconde).
+ * On écrit puis on relit NBE millions de bits dans le fichier "xxx" :
+ * d'abord bit par bit (put_bit/get_bit)
+ * puis par paquets de 13 bits (put_bits/get_bits),
+ * enfin en relisant le fichier projeté en mémoire (mode "rm").
+ */
+
+static void affiche_debit(const char *nom, clock_t debut, double nb_bits)
+{
+  double duree = (clock() - debut) / (double)CLOCKS_PER_SEC ;
+
+  fprintf(stderr, "%-12s : %8.1f Mbits/s\n", nom
+	  , duree > 0 ? nb_bits / duree / 1e6 : 0.) ;
+}
+
+void filtre_bench_bits(struct parametres *p)
+{
+  struct bitstream *bs ;
+  long i, nb_bits, nb_paquets ;
+  unsigned int somme ;
+  clock_t debut ;
+
+  nb_bits = p->nbe * 1000000L ;
+  nb_paquets = nb_bits / 13 ;
+  somme = 0 ;
+
+  debut = clock() ;
+  bs = open_bitstream("xxx", "w") ;
+  for(i=0; i<nb_bits; i++)
+    put_bit(bs, (i*7) & 4) ;
+  close_bitstream(bs) ;
+  affiche_debit("put_bit", debut, nb_bits) ;
+
+  debut = clock() ;
+  bs = open_bitstream("xxx", "r") ;
+  for(i=0; i<nb_bits; i++)
+    somme += get_bit(bs) ;
+  close_bitstream(bs) ;
+  affiche_debit("get_bit", debut, nb_bits) ;
+
+  debut = clock() ;
+  bs = open_bitstream("xxx", "w") ;
+  for(i=0; i<nb_paquets; i++)
+    put_bits(bs, 13, i) ;
+  close_bitstream(bs) ;
+  affiche_debit("put_bits", debut, 13. * nb_paquets) ;
+
+  debut = clock() ;
+  bs = open_bitstream("xxx", "r") ;
+  for(i=0; i<nb_paquets; i++)
+    somme += get_bits(bs, 13) ;
+  close_bitstream(bs) ;
+  affiche_debit("get_bits", debut, 13. * nb_paquets) ;
+
+  debut = clock() ;
+  bs = open_bitstream("xxx", "rm") ;
+  for(i=0; i<nb_paquets; i++)
+    somme += get_bits(bs, 13) ;
+  close_bitstream(bs) ;
+  affiche_debit("get_bits rm", debut, 13. * nb_paquets) ;
+
+  unlink("xxx") ;
+  if ( somme == 0 )
+    fprintf(stderr, "Somme de contrôle nulle\n") ;
 }
 
 #define ARG(X) { #X, (char*)&pp.X - (char*)&pp }
@@ -455,6 +997,7 @@ void filtres(int argc, char **argv)
     { "prediction"  ,  filtre_prediction     , 0, 128, 33, 10 , 0},
     { "prediction2" ,  filtre_prediction     , 0, 128, 33, 10 , 1},
     { "prediction3" ,  filtre_prediction     , 0, 128, 33, 10 , 2},
+    { "bench_bits"  ,  filtre_bench_bits     , 0,  64, 33, 10 , 0},
   } ;
 
   struct parametres pp ;
@@ -486,6 +1029,27 @@ void filtres(int argc, char **argv)
 	if ( getenv("SAUTE_ENTETE") )
 	  pp.saute_entete = atof(getenv("SAUTE_ENTETE")) ;
 
+	if ( getenv("ASYNC") )
+	  pp.asynchrone = atoi(getenv("ASYNC")) ;
+
+	if ( getenv("FENETRE") )
+	  pp.fenetre = atoi(getenv("FENETRE")) ;
+
+	if ( getenv("RICE") )
+	  pp.rice = atoi(getenv("RICE")) ;
+
+	if ( getenv("CONTEXTES") )
+	  pp.contextes = atoi(getenv("CONTEXTES")) ;
+
+	pp.modele = getenv("MODELE") ;
+	pp.sauve_modele = getenv("SAUVE_MODELE") ;
+
+	if ( getenv("TRANCHES") )
+	  pp.tranches = atoi(getenv("TRANCHES")) ;
+
+	if ( getenv("JOINT") )
+	  pp.joint = atoi(getenv("JOINT")) ;
+
 	(*p[i].fct)(&pp) ;
 	exit(0) ;
       }
@@ -0,0 +1,419 @@
+/*
+ * Huffman canonique en deux passes.
+ *
+ * Les valeurs sont stockées par blocs de TAILLE_BLOC valeurs.
+ * Pour chaque bloc, on compte les occurrences des valeurs (1ère passe),
+ * on calcule les longueurs des codes de Huffman puis on écrit
+ * dans l'entête du bloc seulement les valeurs et leurs longueurs :
+ * le code canonique s'en déduit (codes consécutifs par longueur
+ * puis par valeur). Ensuite on écrit les codes (2ème passe).
+ *
+ *    nombre de valeurs du bloc           (Exp-Golomb)
+ *    nombre de valeurs différentes       (Exp-Golomb)
+ *    la plus petite valeur               (32 bits)
+ *    les écarts entre valeurs - 1        (Exp-Golomb)
+ *    les différences de longueurs        (Exp-Golomb signé)
+ *    les codes
+ *
+ * Comme les valeurs ne sont écrites que quand le bloc est plein
+ * (ou par "vide_huffman"), le "bitstream" ne doit pas être partagé
+ * avec un autre codeur.
+ *
+ * Le décodage utilise une table à deux niveaux : les BITS_NIVEAU
+ * prochains bits donnent directement la valeur et la longueur de
+ * son code, ou bien une sous-table indexée par les bits suivants.
+ */
+
+#include "bit.h"
+#include "bits.h"
+#include "entier.h"
+#include "huffman.h"
+
+#define TAILLE_BLOC (1 << 16)
+#define LONGUEUR_MAX 20
+#define BITS_NIVEAU 9
+
+struct symbole
+ {
+  int valeur ;
+  int nb_occurrences ;
+  int longueur ;
+  unsigned int code ;
+ } ;
+
+/*
+ * Si "sous_bits" est nul, "valeur" est la valeur décodée
+ * et "longueur" le nombre de bits à consommer.
+ * Sinon "valeur" est la position de la sous-table de "sous_bits" bits.
+ */
+
+struct decodage
+ {
+  int valeur ;
+  unsigned char longueur ;
+  unsigned char sous_bits ;
+ } ;
+
+struct huffman
+ {
+  int *valeurs ;                /* Le bloc en cours d'écriture */
+  int nb_valeurs ;
+  struct symbole *symboles ;    /* Triés par valeur */
+  int nb_symboles ;
+  int reste ;                   /* Valeurs à lire dans le bloc */
+  struct decodage *decodage ;
+  int longueur_max ;
+ } ;
+
+struct huffman* open_huffman()
+{
+  struct huffman *h ;
+
+  ALLOUER(h, 1) ;
+  ALLOUER(h->valeurs, TAILLE_BLOC) ;
+  ALLOUER(h->symboles, TAILLE_BLOC) ;
+  h->nb_valeurs = 0 ;
+  h->nb_symboles = 0 ;
+  h->reste = 0 ;
+  h->decodage = NULL ;
+  h->longueur_max = 0 ;
+  return h ;
+}
+
+void close_huffman(struct huffman *h)
+{
+  free(h->valeurs) ;
+  free(h->symboles) ;
+  free(h->decodage) ;
+  free(h) ;
+}
+
+static int compare_entiers(const void *a, const void *b)
+{
+  int x = *(const int*)a, y = *(const int*)b ;
+
+  return x < y ? -1 : x > y ;
+}
+
+/*
+ * Les symboles sont triés par valeur (recherche par "bsearch").
+ */
+
+static int compare_symboles(const void *a, const void *b)
+{
+  const struct symbole *x = a, *y = b ;
+
+  return x->valeur < y->valeur ? -1 : x->valeur > y->valeur ;
+}
+
+/*
+ * Calcul des longueurs de Huffman avec deux files
+ * (les feuilles triées par occurrences et les noeuds internes
+ * qui sont créés dans l'ordre croissant des poids).
+ * Si un code dépasse LONGUEUR_MAX on divise les occurrences par 2
+ * et on recommence.
+ */
+
+struct feuille
+ {
+  unsigned long poids ;
+  int symbole ;
+ } ;
+
+static int compare_feuilles(const void *a, const void *b)
+{
+  const struct feuille *x = a, *y = b ;
+
+  if ( x->poids != y->poids )
+    return x->poids < y->poids ? -1 : 1 ;
+  return x->symbole - y->symbole ;
+}
+
+static void calcule_longueurs(struct huffman *h)
+{
+  int n = h->nb_symboles, i, t, a, il, ii, *pere ;
+  unsigned long *poids, facteur = 0 ;
+  struct feuille *feuilles ;
+
+  h->longueur_max = 0 ;
+  if ( n == 1 )
+    {
+      h->symboles[0].longueur = 0 ;
+      return ;
+    }
+  ALLOUER(feuilles, n) ;
+  ALLOUER(poids, 2*n - 1) ;
+  ALLOUER(pere, 2*n - 1) ;
+  do
+    {
+      for(i=0; i<n; i++)
+	{
+	  feuilles[i].poids = ((h->symboles[i].nb_occurrences - 1ul)
+			       >> facteur) + 1 ;
+	  feuilles[i].symbole = i ;
+	}
+      qsort(feuilles, n, sizeof(*feuilles), compare_feuilles) ;
+      for(i=0; i<n; i++)
+	poids[i] = feuilles[i].poids ;
+
+      il = 0 ;
+      ii = n ;
+      for(t=n; t<2*n-1; t++)
+	{
+	  poids[t] = 0 ;
+	  for(i=0; i<2; i++)
+	    {
+	      if ( il < n && (ii == t || poids[il] <= poids[ii]) )
+		a = il++ ;
+	      else
+		a = ii++ ;
+	      poids[t] += poids[a] ;
+	      pere[a] = t ;
+	    }
+	}
+      /* "poids" sert maintenant pour les profondeurs */
+      poids[2*n - 2] = 0 ;
+      h->longueur_max = 0 ;
+      for(t=2*n-3; t>=0; t--)
+	{
+	  poids[t] = poids[pere[t]] + 1 ;
+	  if ( t < n )
+	    {
+	      h->symboles[feuilles[t].symbole].longueur = poids[t] ;
+	      if ( poids[t] > h->longueur_max )
+		h->longueur_max = poids[t] ;
+	    }
+	}
+      facteur++ ;
+    }
+  while( h->longueur_max > LONGUEUR_MAX ) ;
+  free(feuilles) ;
+  free(poids) ;
+  free(pere) ;
+}
+
+/*
+ * Code canonique : pour chaque longueur, les codes sont consécutifs
+ * dans l'ordre des valeurs.
+ */
+
+static void calcule_codes(struct huffman *h)
+{
+  int nb[LONGUEUR_MAX + 1] = { 0 } ;
+  unsigned int suivant[LONGUEUR_MAX + 1], code ;
+  int i ;
+
+  for(i=0; i<h->nb_symboles; i++)
+    nb[h->symboles[i].longueur]++ ;
+  nb[0] = 0 ;
+  code = 0 ;
+  for(i=1; i<=LONGUEUR_MAX; i++)
+    {
+      code = (code + nb[i-1]) << 1 ;
+      suivant[i] = code ;
+    }
+  for(i=0; i<h->nb_symboles; i++)
+    if ( h->symboles[i].longueur )
+      h->symboles[i].code = suivant[h->symboles[i].longueur]++ ;
+    else
+      h->symboles[i].code = 0 ;
+}
+
+/*
+ * Construit la table de décodage à deux niveaux.
+ */
+
+static void construit_decodage(struct huffman *h)
+{
+  int sous_longueur[1 << BITS_NIVEAU] = { 0 } ;
+  int i, j, taille, debut, nb, prefixe ;
+  const struct symbole *s ;
+  struct decodage *d ;
+
+  taille = 1 << BITS_NIVEAU ;
+  for(i=0; i<h->nb_symboles; i++)
+    {
+      s = &h->symboles[i] ;
+      if ( s->longueur > BITS_NIVEAU )
+	{
+	  prefixe = s->code >> (s->longueur - BITS_NIVEAU) ;
+	  if ( s->longueur - BITS_NIVEAU > sous_longueur[prefixe] )
+	    sous_longueur[prefixe] = s->longueur - BITS_NIVEAU ;
+	}
+    }
+  for(i=0; i<1<<BITS_NIVEAU; i++)
+    if ( sous_longueur[i] )
+      taille += 1 << sous_longueur[i] ;
+
+  free(h->decodage) ;
+  ALLOUER(h->decodage, taille) ;
+  taille = 1 << BITS_NIVEAU ;
+  for(i=0; i<1<<BITS_NIVEAU; i++)
+    if ( sous_longueur[i] )
+      {
+	h->decodage[i].valeur = taille ;
+	h->decodage[i].longueur = 0 ;
+	h->decodage[i].sous_bits = sous_longueur[i] ;
+	taille += 1 << sous_longueur[i] ;
+      }
+
+  for(i=0; i<h->nb_symboles; i++)
+    {
+      s = &h->symboles[i] ;
+      if ( s->longueur <= BITS_NIVEAU )
+	{
+	  d = h->decodage ;
+	  debut = s->code << (BITS_NIVEAU - s->longueur) ;
+	  nb = 1 << (BITS_NIVEAU - s->longueur) ;
+	}
+      else
+	{
+	  prefixe = s->code >> (s->longueur - BITS_NIVEAU) ;
+	  d = h->decodage + h->decodage[prefixe].valeur ;
+	  debut = (s->code & ((1u << (s->longueur - BITS_NIVEAU)) - 1))
+	    << (sous_longueur[prefixe] - (s->longueur - BITS_NIVEAU)) ;
+	  nb = 1 << (sous_longueur[prefixe] - (s->longueur - BITS_NIVEAU)) ;
+	}
+      for(j=debut; j<debut+nb; j++)
+	{
+	  d[j].valeur = s->valeur ;
+	  d[j].longueur = s->longueur <= BITS_NIVEAU
+	    ? s->longueur : s->longueur - BITS_NIVEAU ;
+	  d[j].sous_bits = 0 ;
+	}
+    }
+}
+
+/*
+ * Ecrit le bloc en cours (s'il n'est pas vide) dans le bitstream.
+ */
+
+void vide_huffman(struct bitstream *bs, struct huffman *h)
+{
+  int *tri, i, j, precedente ;
+  struct symbole *s, cle ;
+
+  if ( h->nb_valeurs == 0 )
+    return ;
+
+  /* 1ère passe : les valeurs différentes et leurs occurrences */
+  ALLOUER(tri, h->nb_valeurs) ;
+  memcpy(tri, h->valeurs, h->nb_valeurs * sizeof(*tri)) ;
+  qsort(tri, h->nb_valeurs, sizeof(*tri), compare_entiers) ;
+  h->nb_symboles = 0 ;
+  for(i=0; i<h->nb_valeurs; i=j)
+    {
+      for(j=i+1; j<h->nb_valeurs && tri[j] == tri[i]; j++)
+	;
+      s = &h->symboles[h->nb_symboles++] ;
+      s->valeur = tri[i] ;
+      s->nb_occurrences = j - i ;
+    }
+  free(tri) ;
+  calcule_longueurs(h) ;
+  calcule_codes(h) ;
+
+  /* L'entête */
+  put_exp_golomb(bs, h->nb_valeurs - 1) ;
+  put_exp_golomb(bs, h->nb_symboles - 1) ;
+  put_bits(bs, 32, (unsigned int)h->symboles[0].valeur) ;
+  for(i=1; i<h->nb_symboles; i++)
+    put_exp_golomb(bs, (unsigned int)h->symboles[i].valeur
+		   - (unsigned int)h->symboles[i-1].valeur - 1) ;
+  precedente = 0 ;
+  for(i=0; i<h->nb_symboles; i++)
+    {
+      j = h->symboles[i].longueur - precedente ;
+      put_exp_golomb(bs, j >= 0 ? 2*j : -2*j - 1) ;
+      precedente = h->symboles[i].longueur ;
+    }
+
+  /* 2ème passe : les codes */
+  for(i=0; i<h->nb_valeurs; i++)
+    {
+      cle.valeur = h->valeurs[i] ;
+      s = bsearch(&cle, h->symboles, h->nb_symboles, sizeof(*s)
+		  , compare_symboles) ;
+      put_bits(bs, s->longueur, s->code) ;
+    }
+  h->nb_valeurs = 0 ;
+}
+
+void put_entier_huffman(struct bitstream *bs, struct huffman *h, int evenement)
+{
+  h->valeurs[h->nb_valeurs++] = evenement ;
+  if ( h->nb_valeurs == TAILLE_BLOC )
+    vide_huffman(bs, h) ;
+}
+
+/*
+ * Lit l'entête d'un bloc et construit sa table de décodage.
+ *
+ * Les longueurs d'un entête corrompu pourraient donner des codes
+ * plus longs que leur longueur et une table de décodage incomplète :
+ * elles doivent décrire un arbre complet, la somme des 2^-longueur
+ * vaut exactement 1 (un seul symbole a un code de longueur 0).
+ */
+
+static void lit_entete(struct bitstream *bs, struct huffman *h)
+{
+  int i, j, precedente ;
+  unsigned int v ;
+  unsigned long kraft ;
+
+  h->reste = get_exp_golomb(bs) + 1 ;
+  h->nb_symboles = get_exp_golomb(bs) + 1 ;
+  if ( h->reste > TAILLE_BLOC || h->nb_symboles > h->reste )
+    EXIT ;
+  h->symboles[0].valeur = get_bits(bs, 32) ;
+  for(i=1; i<h->nb_symboles; i++)
+    h->symboles[i].valeur = (unsigned int)h->symboles[i-1].valeur
+      + get_exp_golomb(bs) + 1 ;
+  precedente = 0 ;
+  h->longueur_max = 0 ;
+  for(i=0; i<h->nb_symboles; i++)
+    {
+      v = get_exp_golomb(bs) ;
+      j = v & 1 ? -(int)(v/2) - 1 : (int)(v/2) ;
+      h->symboles[i].longueur = precedente + j ;
+      precedente = h->symboles[i].longueur ;
+      if ( precedente < 0 || precedente > LONGUEUR_MAX )
+	EXIT ;
+      if ( precedente > h->longueur_max )
+	h->longueur_max = precedente ;
+    }
+  kraft = 0 ;
+  for(i=0; i<h->nb_symboles; i++)
+    kraft += 1ul << (LONGUEUR_MAX - h->symboles[i].longueur) ;
+  if ( kraft != 1ul << LONGUEUR_MAX )
+    EXIT ;
+  calcule_codes(h) ;
+  construit_decodage(h) ;
+}
+
+int get_entier_huffman(struct bitstream *bs, struct huffman *h)
+{
+  const struct decodage *d ;
+
+  if ( h->reste == 0 )
+    lit_entete(bs, h) ;
+  h->reste-- ;
+
+  d = &h->decodage[peek_bits(bs, BITS_NIVEAU)] ;
+  if ( d->sous_bits )
+    {
+      skip_bits(bs, BITS_NIVEAU) ;
+      d = &h->decodage[d->valeur + peek_bits(bs, d->sous_bits)] ;
+    }
+  skip_bits(bs, d->longueur) ;
+  return d->valeur ;
+}
+
+/*
+ * Fonctions pour les tests, NE PAS MODIFIER
+ */
+
+int huffman_longueur_max(const struct huffman *h)
+{
+  return h->longueur_max ;
+}
@@ -0,0 +1,22 @@
+/*
+ * Huffman canonique en deux passes
+ */
+
+#ifndef _HOME_EXCO_REDACTEX_COURS_TRANS_COMP_IMAGE_TP_DCT2_HUFFMAN_H
+#define _HOME_EXCO_REDACTEX_COURS_TRANS_COMP_IMAGE_TP_DCT2_HUFFMAN_H
+
+#include "bitstream.h"
+
+struct huffman ;
+
+struct huffman* open_huffman() ;
+void close_huffman(struct huffman *h) ;
+void put_entier_huffman(struct bitstream *bs, struct huffman *h, int evenement) ;
+void vide_huffman(struct bitstream *bs, struct huffman *h) ;
+int get_entier_huffman(struct bitstream *bs, struct huffman *h) ;
+
+/* Pour les tests */
+
+int huffman_longueur_max(const struct huffman *h) ; /**/
+
+#endif
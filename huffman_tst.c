@@ -0,0 +1,269 @@
+#include <limits.h>
+#include "huffman.h"
+#include "bits.h"
+#include "entier.h"
+#include <signal.h>
+#include <sys/wait.h>
+
+/*
+ * Ecrit "nb" valeurs de "valeur(i)" en mémoire, les relit
+ * et retourne la taille en octets (-1 si une valeur est mal lue).
+ * "longueur_max" reçoit la longueur max des codes du dernier bloc.
+ */
+
+static int huffman_test(int nb, int (*valeur)(int), int *longueur_max)
+{
+  struct huffman *h ;
+  struct bitstream *bs ;
+  unsigned char *octets ;
+  size_t taille ;
+  int i, v ;
+
+  octets = NULL ;
+  taille = 0 ;
+  h = open_huffman() ;
+  bs = open_bitstream_memory(&octets, &taille, "w") ;
+  for(i=0; i<nb; i++)
+    put_entier_huffman(bs, h, valeur(i)) ;
+  vide_huffman(bs, h) ;
+  close_bitstream(bs) ;
+  if ( longueur_max )
+    *longueur_max = huffman_longueur_max(h) ;
+  close_huffman(h) ;
+
+  h = open_huffman() ;
+  bs = open_bitstream_memory(&octets, &taille, "r") ;
+  for(i=0; i<nb; i++)
+    {
+      v = get_entier_huffman(bs, h) ;
+      if ( v != valeur(i) )
+	{
+	  eprintf("La valeur %d vaut %d au lieu de %d\n", i, v, valeur(i)) ;
+	  taille = -1 ;
+	  break ;
+	}
+    }
+  close_bitstream(bs) ;
+  close_huffman(h) ;
+  free(octets) ;
+  return taille ;
+}
+
+static int constante(int i)
+{
+  return -7 ;
+}
+
+static int biaisee(int i)
+{
+  return i % 5 ? (i % 3) : (i * 7919) % 3001 - 1500 ;
+}
+
+static int extremes(int i)
+{
+  switch(i % 4)
+    {
+    case 0: return INT_MIN ;
+    case 1: return INT_MAX ;
+    case 2: return 0 ;
+    default: return i ;
+    }
+}
+
+/*
+ * Le symbole "k" apparaît fibonacci(k+1) fois : sans limite,
+ * le code le plus long ferait 21 bits.
+ */
+
+static int fibonacci(int i)
+{
+  int a = 1, b = 1, c, k = 0 ;
+
+  while( i >= a )
+    {
+      i -= a ;
+      c = a + b ;
+      a = b ;
+      b = c ;
+      k++ ;
+    }
+  return k ;
+}
+
+void open_huffman_tst()
+{
+  struct huffman *h ;
+
+  h = open_huffman() ;
+  if ( h == NULL )
+    {
+      eprintf("Elle retourne NULL !\n") ;
+      return ;
+    }
+  close_huffman(h) ;
+}
+
+void close_huffman_tst()
+{
+  struct huffman *h ;
+  struct bitstream *bs ;
+  unsigned char *octets = NULL ;
+  size_t taille = 0 ;
+
+  /* Fermer sans vider n'écrit rien */
+  h = open_huffman() ;
+  bs = open_bitstream_memory(&octets, &taille, "w") ;
+  put_entier_huffman(bs, h, 1) ;
+  close_huffman(h) ;
+  close_bitstream(bs) ;
+  if ( taille != 0 )
+    {
+      eprintf("La fermeture ne doit pas écrire le bloc\n") ;
+      return ;
+    }
+  free(octets) ;
+}
+
+void put_entier_huffman_tst()
+{
+  int t ;
+
+  t = huffman_test(10000, constante, NULL) ;
+  if ( t < 0 )
+    return ;
+  if ( t > 10 )
+    {
+      eprintf("Une valeur constante ne doit coûter que l'entête"
+	      " (%d octets)\n", t) ;
+      return ;
+    }
+  t = huffman_test(100000, biaisee, NULL) ;
+  if ( t < 0 )
+    return ;
+  if ( t > 100000 * 5 / 8 )
+    {
+      eprintf("Le codage est trop long : %d octets\n", t) ;
+      return ;
+    }
+}
+
+void vide_huffman_tst()
+{
+  struct huffman *h ;
+  struct bitstream *bs ;
+  unsigned char *octets = NULL ;
+  size_t taille = 0 ;
+  int i ;
+
+  /* Deux blocs courts puis un vidage sans valeur */
+  h = open_huffman() ;
+  bs = open_bitstream_memory(&octets, &taille, "w") ;
+  for(i=0; i<10; i++)
+    put_entier_huffman(bs, h, i) ;
+  vide_huffman(bs, h) ;
+  put_entier_huffman(bs, h, 1000) ;
+  vide_huffman(bs, h) ;
+  vide_huffman(bs, h) ;
+  close_bitstream(bs) ;
+  close_huffman(h) ;
+
+  h = open_huffman() ;
+  bs = open_bitstream_memory(&octets, &taille, "r") ;
+  for(i=0; i<10; i++)
+    if ( get_entier_huffman(bs, h) != i )
+      {
+	eprintf("Premier bloc mal relu\n") ;
+	return ;
+      }
+  if ( get_entier_huffman(bs, h) != 1000 )
+    {
+      eprintf("Second bloc mal relu\n") ;
+      return ;
+    }
+  close_bitstream(bs) ;
+  close_huffman(h) ;
+  free(octets) ;
+}
+
+/*
+ * Un entête écrit à la main avec les longueurs "longueurs"
+ * (différences codées comme dans "vide_huffman"),
+ * décodé dans un processus fils : s'arrête-t-il (EXIT) ?
+ */
+
+static int entete_arrete(const int *longueurs, int nb)
+{
+  struct huffman *h ;
+  struct bitstream *bs ;
+  unsigned char *octets ;
+  size_t taille ;
+  int i, j, precedente, status ;
+
+  octets = NULL ;
+  taille = 0 ;
+  bs = open_bitstream_memory(&octets, &taille, "w") ;
+  put_exp_golomb(bs, nb - 1) ;	/* Une fois chaque valeur */
+  put_exp_golomb(bs, nb - 1) ;
+  put_bits(bs, 32, 0) ;
+  for(i=1; i<nb; i++)
+    put_exp_golomb(bs, 0) ;
+  precedente = 0 ;
+  for(i=0; i<nb; i++)
+    {
+      j = longueurs[i] - precedente ;
+      put_exp_golomb(bs, j >= 0 ? 2*j : -2*j - 1) ;
+      precedente = longueurs[i] ;
+    }
+  put_bits(bs, 32, 0) ;
+  put_bits(bs, 32, 0) ;
+  close_bitstream(bs) ;
+
+  if ( fork() == 0 )
+    {
+      close(2) ;
+      h = open_huffman() ;
+      bs = open_bitstream_memory_read(octets, taille) ;
+      get_entier_huffman(bs, h) ;
+      exit(0) ;
+    }
+  wait(&status) ;
+  free(octets) ;
+  return WIFSIGNALED(status) && WTERMSIG(status) == SIGABRT ;
+}
+
+void get_entier_huffman_tst()
+{
+  static const int complet[] = { 1, 2, 3, 3 } ;
+  static const int trop[] = { 1, 1, 2 } ;
+  static const int incomplet[] = { 2, 2, 2 } ;
+  static const int nul[] = { 0, 1 } ;
+
+  int longueur_max ;
+
+  if ( huffman_test(200000, biaisee, NULL) < 0 )
+    return ;
+  if ( huffman_test(1000, extremes, NULL) < 0 )
+    return ;
+  if ( huffman_test(46367, fibonacci, &longueur_max) < 0 )
+    return ;
+  if ( longueur_max > 20 || longueur_max <= 9 )
+    {
+      eprintf("Codes de %d bits au maximum, il faut entre 10 et 20\n"
+	      , longueur_max) ;
+      return ;
+    }
+
+  /* Les longueurs de l'entête doivent vérifier l'égalité de Kraft */
+  if ( entete_arrete(complet, TAILLE(complet)) )
+    {
+      eprintf("Un entête valide est refusé\n") ;
+      return ;
+    }
+  if ( !entete_arrete(trop, TAILLE(trop))
+       || !entete_arrete(incomplet, TAILLE(incomplet))
+       || !entete_arrete(nul, TAILLE(nul)) )
+    {
+      eprintf("Des longueurs de codes impossibles sont acceptées\n") ;
+      return ;
+    }
+}
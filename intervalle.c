@@ -0,0 +1,284 @@
+/*
+ * Codage par intervalles (range coder) adaptatif.
+ *
+ * L'intervalle courant [bas, bas+etendue[ est découpé
+ * proportionnellement aux fréquences des symboles, on garde
+ * le morceau du symbole codé. Quand l'étendue devient plus petite
+ * que 2^24, on sort l'octet de poids fort de "bas" (renormalisation
+ * par octet et non par bit). Une retenue peut encore modifier
+ * l'octet sorti : il reste dans "cache" avec les "nb_cache - 1"
+ * octets 0xFF qui le suivent.
+ *
+ * Le modèle est adaptatif : on compte les occurrences des symboles
+ * (avec remise à l'échelle quand le total dépasse TOTAL_MAX).
+ * Le symbole d'une valeur est son entier "zigzag"
+ * (0 -1 1 -2 2 ... donnent 0 1 2 3 4 ...) s'il est plus petit
+ * que NB_DIRECTS, sinon le symbole ESCAPE+n-9 pour un zigzag
+ * de n bits, suivi de ses n-1 bits de poids faible.
+ * Comme les valeurs sont presque toutes petites, le cumul
+ * des fréquences se calcule en parcourant la table depuis 0.
+ *
+ * Le symbole FIN termine le flot : le décodeur lance alors
+ * Exception_fichier_lecture comme en fin de fichier.
+ *
+ * Comme le décodeur lit 4 octets d'avance, le "bitstream"
+ * ne doit pas être partagé avec un autre codeur.
+ */
+
+#include <stdint.h>
+#include "bits.h"
+#include "exception.h"
+#include "intervalle.h"
+
+#define NB_DIRECTS 256          /* Les zigzag de 8 bits ou moins */
+#define ESCAPE NB_DIRECTS
+#define FIN (ESCAPE + 32 - 8)
+#define NB_SYMBOLES (FIN + 1)
+
+#define INCREMENT 24
+#define TOTAL_MAX (1 << 16)
+#define HAUT (1u << 24)
+
+struct intervalle
+ {
+  uint64_t bas ;
+  uint32_t etendue ;
+  uint32_t code ;              /* Décodeur : position dans l'intervalle */
+  int demarre ;                /* Décodeur : 1 si les premiers octets sont lus,
+				  2 si FIN est lu */
+  unsigned char cache ;
+  unsigned long nb_cache ;
+  unsigned int frequences[NB_SYMBOLES] ;
+  unsigned int total ;
+ } ;
+
+struct intervalle* open_intervalle()
+{
+  struct intervalle *ic ;
+  int i ;
+
+  ALLOUER(ic, 1) ;
+  ic->bas = 0 ;
+  ic->etendue = 0xFFFFFFFF ;
+  ic->code = 0 ;
+  ic->demarre = 0 ;
+  ic->cache = 0 ;
+  ic->nb_cache = 1 ;
+  for(i=0; i<NB_SYMBOLES; i++)
+    ic->frequences[i] = 1 ;
+  ic->total = NB_SYMBOLES ;
+  return ic ;
+}
+
+void close_intervalle(struct intervalle *ic)
+{
+  free(ic) ;
+}
+
+/*
+ * Le modèle : cumul des fréquences et mise à jour.
+ * FIN garde toujours la fréquence 1.
+ */
+
+static unsigned int cumul(const struct intervalle *ic, int symbole)
+{
+  unsigned int c = 0 ;
+  int i ;
+
+  for(i=0; i<symbole; i++)
+    c += ic->frequences[i] ;
+  return c ;
+}
+
+static void incremente(struct intervalle *ic, int symbole)
+{
+  int i ;
+
+  if ( symbole == FIN )
+    return ;
+  ic->frequences[symbole] += INCREMENT ;
+  ic->total += INCREMENT ;
+  if ( ic->total > TOTAL_MAX )
+    {
+      ic->total = 0 ;
+      for(i=0; i<NB_SYMBOLES; i++)
+	{
+	  if ( i != FIN )
+	    ic->frequences[i] = (ic->frequences[i] + 1) / 2 ;
+	  ic->total += ic->frequences[i] ;
+	}
+    }
+}
+
+/*
+ * Codeur
+ */
+
+static void sort_octet(struct bitstream *bs, struct intervalle *ic)
+{
+  unsigned char c ;
+
+  if ( (uint32_t)ic->bas < 0xFF000000u || (ic->bas >> 32) != 0 )
+    {
+      c = ic->cache ;
+      do
+	{
+	  put_bits(bs, 8, (unsigned char)(c + (ic->bas >> 32))) ;
+	  c = 0xFF ;
+	}
+      while( --ic->nb_cache ) ;
+      ic->cache = (uint32_t)ic->bas >> 24 ;
+    }
+  ic->nb_cache++ ;
+  ic->bas = (uint32_t)(ic->bas << 8) ;
+}
+
+static void code_intervalle(struct bitstream *bs, struct intervalle *ic
+			    , unsigned int debut, unsigned int taille
+			    , unsigned int total)
+{
+  uint32_t r = ic->etendue / total ;
+
+  ic->bas += (uint64_t)r * debut ;
+  ic->etendue = r * taille ;
+  while( ic->etendue < HAUT )
+    {
+      ic->etendue <<= 8 ;
+      sort_octet(bs, ic) ;
+    }
+}
+
+static void code_symbole(struct bitstream *bs, struct intervalle *ic
+			 , int symbole)
+{
+  code_intervalle(bs, ic, cumul(ic, symbole), ic->frequences[symbole]
+		  , ic->total) ;
+  incremente(ic, symbole) ;
+}
+
+/*
+ * Les bits de poids faible des grandes valeurs ont une
+ * probabilité uniforme (par morceaux de 16 bits au plus).
+ */
+
+static void code_bits(struct bitstream *bs, struct intervalle *ic
+		      , int nb, unsigned int v)
+{
+  if ( nb > 16 )
+    {
+      code_bits(bs, ic, nb - 16, v >> 16) ;
+      nb = 16 ;
+    }
+  code_intervalle(bs, ic, v & ((1u << nb) - 1), 1, 1u << nb) ;
+}
+
+void put_entier_intervalle(struct bitstream *bs, struct intervalle *ic
+			   , int evenement)
+{
+  unsigned int z = evenement >= 0 ? 2u*evenement : -2u*evenement - 1 ;
+  int nb ;
+
+  if ( z < NB_DIRECTS )
+    code_symbole(bs, ic, z) ;
+  else
+    {
+      nb = nb_bits_utile(z) ;
+      code_symbole(bs, ic, ESCAPE + nb - 9) ;
+      code_bits(bs, ic, nb - 1, z) ;
+    }
+}
+
+/*
+ * Code FIN puis sort les derniers octets.
+ * A appeler une seule fois, après la dernière valeur.
+ */
+
+void vide_intervalle(struct bitstream *bs, struct intervalle *ic)
+{
+  int i ;
+
+  code_symbole(bs, ic, FIN) ;
+  for(i=0; i<5; i++)
+    sort_octet(bs, ic) ;
+}
+
+/*
+ * Décodeur
+ */
+
+static unsigned int position(struct bitstream *bs, struct intervalle *ic
+			     , unsigned int total, uint32_t *r)
+{
+  unsigned int v ;
+  int i ;
+
+  if ( !ic->demarre )
+    {
+      /* Le premier octet est toujours le "cache" initial nul */
+      for(i=0; i<5; i++)
+	ic->code = (ic->code << 8) | get_bits(bs, 8) ;
+      ic->demarre = 1 ;
+    }
+  *r = ic->etendue / total ;
+  v = ic->code / *r ;
+  return v < total ? v : total - 1 ;
+}
+
+static void decode_intervalle(struct bitstream *bs, struct intervalle *ic
+			      , uint32_t r, unsigned int debut
+			      , unsigned int taille)
+{
+  ic->code -= r * debut ;
+  ic->etendue = r * taille ;
+  while( ic->etendue < HAUT )
+    {
+      ic->etendue <<= 8 ;
+      ic->code = (ic->code << 8) | get_bits(bs, 8) ;
+    }
+}
+
+static unsigned int decode_bits(struct bitstream *bs, struct intervalle *ic
+				, int nb)
+{
+  unsigned int haut = 0, v ;
+  uint32_t r ;
+
+  if ( nb > 16 )
+    {
+      haut = decode_bits(bs, ic, nb - 16) << 16 ;
+      nb = 16 ;
+    }
+  v = position(bs, ic, 1u << nb, &r) ;
+  decode_intervalle(bs, ic, r, v, 1) ;
+  return haut | v ;
+}
+
+int get_entier_intervalle(struct bitstream *bs, struct intervalle *ic)
+{
+  unsigned int v, c, z ;
+  uint32_t r ;
+  int s ;
+
+  if ( ic->demarre == 2 )
+    EXCEPTION_LANCE(Exception_fichier_lecture) ;
+  v = position(bs, ic, ic->total, &r) ;
+  c = 0 ;
+  for(s=0; c + ic->frequences[s] <= v; s++)
+    c += ic->frequences[s] ;
+  decode_intervalle(bs, ic, r, c, ic->frequences[s]) ;
+  incremente(ic, s) ;
+
+  if ( s == FIN )
+    {
+      ic->demarre = 2 ;
+      EXCEPTION_LANCE(Exception_fichier_lecture) ;
+    }
+  if ( s >= ESCAPE )
+    {
+      s += 9 - ESCAPE ;
+      z = (1u << (s - 1)) | decode_bits(bs, ic, s - 1) ;
+    }
+  else
+    z = s ;
+  return z & 1 ? -(int)(z >> 1) - 1 : (int)(z >> 1) ;
+}
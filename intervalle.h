@@ -0,0 +1,18 @@
+/*
+ * Codage par intervalles (range coder) adaptatif
+ */
+
+#ifndef _HOME_EXCO_REDACTEX_COURS_TRANS_COMP_IMAGE_TP_DCT2_INTERVALLE_H
+#define _HOME_EXCO_REDACTEX_COURS_TRANS_COMP_IMAGE_TP_DCT2_INTERVALLE_H
+
+#include "bitstream.h"
+
+struct intervalle ;
+
+struct intervalle* open_intervalle() ;
+void close_intervalle(struct intervalle *ic) ;
+void put_entier_intervalle(struct bitstream *bs, struct intervalle *ic, int evenement) ;
+void vide_intervalle(struct bitstream *bs, struct intervalle *ic) ;
+int get_entier_intervalle(struct bitstream *bs, struct intervalle *ic) ;
+
+#endif
@@ -0,0 +1,139 @@
+#include <limits.h>
+#include "intervalle.h"
+#include "exception.h"
+
+/*
+ * Ecrit "nb" valeurs de "valeur(i)" en mémoire, les relit
+ * (puis vérifie que FIN donne bien l'exception de fin de fichier)
+ * et retourne la taille en octets (-1 en cas d'erreur).
+ */
+
+static int intervalle_test(int nb, int (*valeur)(int))
+{
+  struct intervalle *ic ;
+  struct bitstream *bs ;
+  unsigned char *octets ;
+  size_t taille ;
+  int i, v, fin ;
+
+  octets = NULL ;
+  taille = 0 ;
+  ic = open_intervalle() ;
+  bs = open_bitstream_memory(&octets, &taille, "w") ;
+  for(i=0; i<nb; i++)
+    put_entier_intervalle(bs, ic, valeur(i)) ;
+  vide_intervalle(bs, ic) ;
+  close_bitstream(bs) ;
+  close_intervalle(ic) ;
+
+  ic = open_intervalle() ;
+  bs = open_bitstream_memory(&octets, &taille, "r") ;
+  for(i=0; i<nb; i++)
+    {
+      v = get_entier_intervalle(bs, ic) ;
+      if ( v != valeur(i) )
+	{
+	  eprintf("La valeur %d vaut %d au lieu de %d\n", i, v, valeur(i)) ;
+	  return -1 ;
+	}
+    }
+  fin = 0 ;
+  EXCEPTION(get_entier_intervalle(bs, ic) ;
+	    ,
+	    ,
+	    case Exception_fichier_lecture:
+	    fin = 1 ;
+	    break ;
+	    ) ;
+  if ( !fin )
+    {
+      eprintf("Pas d'exception après la dernière valeur\n") ;
+      return -1 ;
+    }
+  close_bitstream(bs) ;
+  close_intervalle(ic) ;
+  free(octets) ;
+  return taille ;
+}
+
+static int nulle(int i)
+{
+  return 0 ;
+}
+
+static int biaisee(int i)
+{
+  return i % 5 ? (i % 3) : (i * 7919) % 3001 - 1500 ;
+}
+
+static int extremes(int i)
+{
+  switch(i % 5)
+    {
+    case 0: return INT_MIN ;
+    case 1: return INT_MAX ;
+    case 2: return 127 ;
+    case 3: return -128 ;
+    default: return i ;
+    }
+}
+
+void open_intervalle_tst()
+{
+  struct intervalle *ic ;
+
+  ic = open_intervalle() ;
+  if ( ic == NULL )
+    {
+      eprintf("Elle retourne NULL !\n") ;
+      return ;
+    }
+  close_intervalle(ic) ;
+}
+
+void close_intervalle_tst()
+{
+  if ( intervalle_test(0, nulle) < 0 )
+    return ;
+}
+
+void put_entier_intervalle_tst()
+{
+  int t ;
+
+  /* Moins d'un bit par valeur : impossible avec Shannon-Fano */
+  t = intervalle_test(100000, nulle) ;
+  if ( t < 0 )
+    return ;
+  if ( t > 1000 )
+    {
+      eprintf("100000 valeurs nulles prennent %d octets\n", t) ;
+      return ;
+    }
+  t = intervalle_test(100000, biaisee) ;
+  if ( t < 0 )
+    return ;
+  if ( t > 100000 * 5 / 8 )
+    {
+      eprintf("Le codage est trop long : %d octets\n", t) ;
+      return ;
+    }
+}
+
+void vide_intervalle_tst()
+{
+  int i ;
+
+  /* Les retenues et les octets 0xFF en attente en fin de flot */
+  for(i=1; i<300; i+=37)
+    if ( intervalle_test(i, biaisee) < 0 )
+      return ;
+}
+
+void get_entier_intervalle_tst()
+{
+  if ( intervalle_test(1000, extremes) < 0 )
+    return ;
+  if ( intervalle_test(200000, biaisee) < 0 )
+    return ;
+}
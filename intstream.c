@@ -1,5 +1,9 @@
 #include "intstream.h"
 #include "sf.h"
+#include "huffman.h"
+#include "intervalle.h"
+#include "rans.h"
+#include "rice.h"
 #include "entier.h"
 
 struct intstream
@@ -7,6 +11,10 @@ struct intstream
   enum intstream_type type ;
   struct bitstream *bitstream ;           /* Dans tous les cas, le bitstream */
   struct shannon_fano *shannon_fano ;     /* Si type==Shanno_fano */
+  struct huffman *huffman ;               /* Si type==Huffman */
+  struct intervalle *intervalle ;         /* Si type==Intervalle */
+  struct rans *rans ;                     /* Si type==Rans */
+  struct rice *rice ;                     /* Si type==Rice */
 } ;
 
 
@@ -26,12 +34,39 @@ struct intstream* open_intstream(struct bitstream *bitstream
 	EXIT ;
       is->shannon_fano = shannon_fano ;
     }
+  if ( type == Huffman )
+    is->huffman = open_huffman() ;
+  if ( type == Intervalle )
+    is->intervalle = open_intervalle() ;
+  if ( type == Rans )
+    is->rans = open_rans() ;
+  if ( type == Rice )
+    is->rice = open_rice() ;
 
   return(is) ;
 }
 
 void close_intstream(struct intstream *is)
 {
+  if ( is->type == Huffman )
+    {
+      vide_huffman(is->bitstream, is->huffman) ;
+      close_huffman(is->huffman) ;
+    }
+  if ( is->type == Intervalle )
+    {
+      if ( bitstream_en_ecriture(is->bitstream) )
+	vide_intervalle(is->bitstream, is->intervalle) ;
+      close_intervalle(is->intervalle) ;
+    }
+  if ( is->type == Rans )
+    {
+      if ( bitstream_en_ecriture(is->bitstream) )
+	vide_rans(is->bitstream, is->rans) ;
+      close_rans(is->rans) ;
+    }
+  if ( is->type == Rice )
+    close_rice(is->rice) ;
   free(is) ;
 }
 
@@ -42,6 +77,18 @@ void put_entier_intstream(struct intstream *is, int evenement)
     case Shannon_fano:
       put_entier_shannon_fano(is->bitstream, is->shannon_fano, evenement) ;
       break ;
+    case Huffman:
+      put_entier_huffman(is->bitstream, is->huffman, evenement) ;
+      break ;
+    case Intervalle:
+      put_entier_intervalle(is->bitstream, is->intervalle, evenement) ;
+      break ;
+    case Rans:
+      put_entier_rans(is->bitstream, is->rans, evenement) ;
+      break ;
+    case Rice:
+      put_entier_rice(is->bitstream, is->rice, evenement) ;
+      break ;
     case Entier:
       put_entier(is->bitstream, evenement) ;
       break ;
@@ -59,6 +106,14 @@ int get_entier_intstream(struct intstream *is)
     {
     case Shannon_fano:
       return(get_entier_shannon_fano(is->bitstream, is->shannon_fano)) ;
+    case Huffman:
+      return(get_entier_huffman(is->bitstream, is->huffman)) ;
+    case Intervalle:
+      return(get_entier_intervalle(is->bitstream, is->intervalle)) ;
+    case Rans:
+      return(get_entier_rans(is->bitstream, is->rans)) ;
+    case Rice:
+      return(get_entier_rice(is->bitstream, is->rice)) ;
     case Entier:
       return( get_entier(is->bitstream) ) ;
     case Entier_Signe:
@@ -20,10 +20,25 @@ enum intstream_type
 {  Entier
   ,Entier_Signe
   ,Shannon_fano
+  ,Huffman
+  ,Intervalle
+  ,Rans
+  ,Rice
 } ;
 
 /*
  * Si "shannon_fano" est null, on utilise le Huffman static
+ *
+ * Le type "Huffman" (canonique en deux passes, voir "huffman.h")
+ * crée son propre modèle et n'écrit les valeurs que par blocs :
+ * il ne peut pas partager son "bitstream" avec un autre "intstream",
+ * il faut utiliser le même "intstream" pour toutes les valeurs.
+ * C'est aussi le cas du type "Intervalle" (codage par intervalles
+ * adaptatif, voir "intervalle.h") dont le décodeur lit en avance
+ * et du type "Rans" (rANS statique par blocs, voir "rans.h").
+ *
+ * Le type "Rice" (Golomb-Rice adaptatif, voir "rice.h") est fait pour
+ * les longueurs des suites de 0 : il n'accepte que les entiers positifs.
  */
 struct intstream* open_intstream(struct bitstream *bitstream
 				 , enum intstream_type type
@@ -31,6 +46,8 @@ struct intstream* open_intstream(struct bitstream *bitstream
 /*
  * La fermeture ne FERME PAS le "bitstream" et le "shannon_fano"
  * car ils n'ont pas été créé par "open_intstream"
+ * (pour les types "Huffman", "Intervalle" et "Rans"
+ * elle termine l'écriture).
  */
 void        close_intstream(struct intstream *is) ;
 void   put_entier_intstream(struct intstream *is, int evenement) ;
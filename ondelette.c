@@ -1,6 +1,7 @@
 #include "bases.h"
 #include "bitstream.h"
 #include "sf.h"
+#include "entier.h"
 #include "intstream.h"
 #include "image.h"
 #include "rle.h"
@@ -145,20 +146,149 @@ void quantif_ondelette(Matrice *image, float qualite)
 
 }
 
+/*
+ * Les "intstream" de la RLE.
+ * Avec Shannon-Fano, CONTEXTES choisit les modèles comme dans "filtres.c" :
+ * 0 (par défaut) un seul modèle pour les longueurs des suites de 0
+ * et les valeurs, 1 un modèle pour chacune,
+ * 2 de plus un couple de modèles par niveau de décomposition (la bande).
+ * Les autres types n'ont qu'un "intstream".
+ */
+
+struct contextes
+{
+  int nb ;			/* Nombre de bandes */
+  struct intstream **entier ;
+  struct intstream **entier_signe ;
+  int nb_sf ;
+  struct shannon_fano **sf ;
+} ;
+
+static void ouvre_intstreams(struct bitstream *bs
+			     , const struct parametres_ondelette *p
+			     , int nb_bandes, struct contextes *c)
+ {
+  int i ;
+
+  c->nb = p->type == Shannon_fano && p->contextes >= 2 ? nb_bandes : 1 ;
+  ALLOUER(c->entier, c->nb) ;
+  ALLOUER(c->entier_signe, c->nb) ;
+  c->nb_sf = 0 ;
+  c->sf = NULL ;
+  switch(p->type)
+    {
+    case Shannon_fano:
+      c->nb_sf = p->contextes ? 2*c->nb : 1 ;
+      ALLOUER(c->sf, c->nb_sf) ;
+      for(i=0; i<c->nb_sf; i++)
+	c->sf[i] = p->fenetre ? open_shannon_fano_fenetre(p->fenetre)
+	  : open_shannon_fano() ;
+      for(i=0; i<c->nb; i++)
+	{
+	  c->entier[i]
+	    = open_intstream(bs, Shannon_fano, c->sf[(2*i) % c->nb_sf]) ;
+	  c->entier_signe[i]
+	    = open_intstream(bs, Shannon_fano, c->sf[(2*i+1) % c->nb_sf]) ;
+	}
+      break ;
+    case Huffman:
+    case Intervalle:
+    case Rans:
+      c->entier[0] = c->entier_signe[0] = open_intstream(bs, p->type, NULL) ;
+      break ;
+    default:
+      EXIT ;
+    }
+ }
+
+static void ferme_intstreams(struct contextes *c)
+ {
+  int i ;
+
+  for(i=0; i<c->nb; i++)
+    {
+      close_intstream(c->entier[i]) ;
+      if ( c->entier_signe[i] != c->entier[i] )
+	close_intstream(c->entier_signe[i]) ;
+    }
+  if ( c->sf )
+    {
+      for(i=0; i<c->nb_sf; i++)
+	close_shannon_fano(c->sf[i]) ;
+      free(c->sf) ;
+    }
+  free(c->entier) ;
+  free(c->entier_signe) ;
+ }
+
+/*
+ * Niveau de décomposition de chaque coefficient dans l'ordre
+ * de la table linéaire (voir ci-dessous), la dernière bande
+ * ne contient que la moyenne de l'image.
+ */
+
+static int* bandes_ondelette(int hau, int lar, int *nb_bandes)
+ {
+  int *bande, *pb, j, i, niveau ;
+
+  ALLOUER(bande, hau*lar) ;
+  pb = bande ;
+  niveau = 0 ;
+  while( hau != 1 || lar != 1 )
+    {
+      for(j=0; j<hau; j++)
+	for(i=0; i<lar; i++)
+	  if ( j>=(hau+1)/2 || i>=(lar+1)/2 )
+	    *pb++ = niveau ;
+
+      hau = (hau+1)/2 ;
+      lar = (lar+1)/2 ;
+      niveau++ ;
+    }
+  *pb = niveau ;
+  *nb_bandes = niveau + 1 ;
+  return bande ;
+ }
+
+/*
+ * RLE d'une table linéaire avec un ou plusieurs contextes.
+ */
+
+static void compresse_contextes(struct contextes *c, const int *bande
+				, int nbe, const float *t)
+ {
+  if ( c->nb == 1 )
+    compresse(c->entier[0], c->entier_signe[0], nbe, t) ;
+  else
+    compresse_bandes(c->entier, c->entier_signe, bande, nbe, t) ;
+ }
+
+static void decompresse_contextes(struct contextes *c, const int *bande
+				  , int nbe, float *t)
+ {
+  if ( c->nb == 1 )
+    decompresse(c->entier[0], c->entier_signe[0], nbe, t) ;
+  else
+    decompresse_bandes(c->entier, c->entier_signe, bande, nbe, t) ;
+ }
+
 /*
  * Sortie des coefficients dans le bonne ordre afin
  * d'être bien compressé par la RLE.
  * Cette fonction n'est pas optimale, elle devrait faire
  * un parcours de Péano sur chacun des blocs.
+ *
+ * Le "bitstream" peut être un fichier ou un flot en mémoire,
+ * il n'est pas fermé.
  */
 
-void codage_ondelette(Matrice *image, FILE *f)
+void codage_ondelette_bitstream(Matrice *image, struct bitstream *bs
+				, const struct parametres_ondelette *p)
  {
   int j, i ;
   float *t, *pt ;
-  struct intstream *entier, *entier_signe ;
-  struct bitstream *bs ;
-  struct shannon_fano *sf ;
+  struct contextes c ;
+  int *bande, nb_bandes ;
   int hau, lar ;
 
   /*
@@ -182,20 +312,31 @@ void codage_ondelette(Matrice *image, FILE *f)
     }
   *pt = image->t[0][0] ;
   /*
-   * Compression RLE avec Shannon-Fano
+   * Compression RLE avec Shannon-Fano, Huffman ou intervalles.
+   * Shannon-Fano donne le format d'origine, les autres types
+   * sont écrits au début pour que le décodeur les vérifie.
    */
-  bs = open_bitstream("-", "w") ;
-  sf = open_shannon_fano() ;
-  entier = open_intstream(bs, Shannon_fano, sf) ;
-  entier_signe = open_intstream(bs, Shannon_fano, sf) ;
+  if ( p->type != Shannon_fano )
+    put_entier(bs, p->type) ;
+  bande = bandes_ondelette(image->height, image->width, &nb_bandes) ;
+  ouvre_intstreams(bs, p, nb_bandes, &c) ;
 
-  compresse(entier, entier_signe, image->height*image->width, t) ;
+  compresse_contextes(&c, bande, image->height*image->width, t) ;
 
-  close_intstream(entier) ;
-  close_intstream(entier_signe) ;
-  close_bitstream(bs) ;
+  ferme_intstreams(&c) ;
+  free(bande) ;
   free(t) ;
  }
+
+void codage_ondelette(Matrice *image, FILE *f
+		      , const struct parametres_ondelette *p)
+ {
+  struct bitstream *bs ;
+
+  bs = open_bitstream("-", "w") ;
+  codage_ondelette_bitstream(image, bs, p) ;
+  close_bitstream(bs) ;
+ }
   
 
 
@@ -277,29 +418,28 @@ void dequantif_ondelette(Matrice *image, float qualite)
 
 }
 
-void decodage_ondelette(Matrice *image, FILE *f)
+void decodage_ondelette_bitstream(Matrice *image, struct bitstream *bs
+				  , const struct parametres_ondelette *p)
  {
   int j, i ;
   float *t, *pt ;
-  struct intstream *entier, *entier_signe ;
-  struct bitstream *bs ;
-  struct shannon_fano *sf ;
+  struct contextes c ;
+  int *bande, nb_bandes ;
   int largeur = image->width, hauteur = image->height ;
 
   /*
-   * Decompression RLE avec Shannon-Fano
+   * Decompression RLE avec Shannon-Fano, Huffman ou intervalles
    */
   ALLOUER(t, hauteur*largeur) ;
-  bs = open_bitstream("-", "r") ;
-  sf = open_shannon_fano() ;
-  entier = open_intstream(bs, Shannon_fano, sf) ;
-  entier_signe = open_intstream(bs, Shannon_fano, sf) ;
+  bande = bandes_ondelette(hauteur, largeur, &nb_bandes) ;
+  if ( p->type != Shannon_fano && get_entier(bs) != p->type )
+    EXIT ;
+  ouvre_intstreams(bs, p, nb_bandes, &c) ;
 
-  decompresse(entier, entier_signe, hauteur*largeur, t) ;
+  decompresse_contextes(&c, bande, hauteur*largeur, t) ;
 
-  close_intstream(entier) ;
-  close_intstream(entier_signe) ;
-  close_bitstream(bs) ;
+  ferme_intstreams(&c) ;
+  free(bande) ;
 
   /*
    * Met dans la matrice
@@ -319,6 +459,16 @@ void decodage_ondelette(Matrice *image, FILE *f)
 
   free(t) ;
  }
+
+void decodage_ondelette(Matrice *image, FILE *f
+			, const struct parametres_ondelette *p)
+ {
+  struct bitstream *bs ;
+
+  bs = open_bitstream("-", "rm") ;
+  decodage_ondelette_bitstream(image, bs, p) ;
+  close_bitstream(bs) ;
+ }
   
 /*
  * Programme de test.
@@ -326,12 +476,16 @@ void decodage_ondelette(Matrice *image, FILE *f)
  * et affiche la taille compressée.
 
 export QUALITE=1  # Qualité de "quantification"
-export SHANNON=1  # Si 1, utilise shannon-fano dynamique
+export SHANNON=1  # Si 3 (4 ou 5), utilise Huffman (les intervalles ou rANS)
+                  # au lieu de shannon-fano dynamique
+                  # Si 2, le code n'est recalculé que toutes les FENETRE valeurs
+export CONTEXTES=0 # Modèles Shannon-Fano (voir "ouvre_intstreams")
 ondelette <DONNEES/bat710.pgm 1 >xxx && ls -ls xxx && ondelette_inv <xxx | xv -
 
  */
 
-void ondelette_encode_image(float qualite)
+void ondelette_encode_image(float qualite
+			    , const struct parametres_ondelette *p)
  {
   struct image *image ;
   Matrice *im ;
@@ -356,12 +510,12 @@ void ondelette_encode_image(float qualite)
   fprintf(stderr, "Quantification qualité = %g\n", qualite) ;
   quantif_ondelette(im, qualite) ;
   fprintf(stderr, "Codage\n") ;
-  codage_ondelette(im, stdout) ;
+  codage_ondelette(im, stdout, p) ;
 
   //  affiche_matrice_float(im, image->hauteur, image->largeur) ;
  }
 
-void ondelette_decode_image()
+void ondelette_decode_image(const struct parametres_ondelette *p)
  {
   int hauteur, largeur ;
   float qualite ;
@@ -375,7 +529,7 @@ void ondelette_decode_image()
   im = allocation_matrice_float(hauteur, largeur) ;
 
   fprintf(stderr, "Décodage\n") ;
-  decodage_ondelette(im, stdin ) ;
+  decodage_ondelette(im, stdin, p) ;
 
   fprintf(stderr, "Déquantification qualité = %g\n", qualite) ;
   dequantif_ondelette(im, qualite) ;
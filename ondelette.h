@@ -11,8 +11,27 @@ void ondelette_2d(Matrice *image) ;
 void ondelette_1d_inverse(const float *entree, float *sortie, int nbe) ;
 void ondelette_2d_inverse(Matrice *image) ;
 
-void ondelette_encode_image(float qualite) ; /**/
-void ondelette_decode_image() ; /**/
+#include "intstream.h"
+
+/*
+ * Codage des coefficients, le décodeur doit avoir les mêmes :
+ * le type d'"intstream" et, pour Shannon-Fano,
+ * la FENETRE (0 : adaptatif, sinon voir "open_shannon_fano_fenetre")
+ * et les CONTEXTES (0 : un seul modèle, 1 : un pour les longueurs
+ * et un pour les valeurs, 2 : de plus un couple par bande).
+ */
+struct parametres_ondelette
+{
+  enum intstream_type type ;
+  int fenetre ;
+  int contextes ;
+} ;
+
+void codage_ondelette_bitstream(Matrice *image, struct bitstream *bs, const struct parametres_ondelette *p) ;
+void decodage_ondelette_bitstream(Matrice *image, struct bitstream *bs, const struct parametres_ondelette *p) ;
+
+void ondelette_encode_image(float qualite, const struct parametres_ondelette *p) ; /**/
+void ondelette_decode_image(const struct parametres_ondelette *p) ; /**/
 
 
 #endif
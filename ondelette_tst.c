@@ -2,6 +2,9 @@
 #include "bases.h"
 #include "matrice.h"
 #include "ondelette.h"
+#include "bitstream.h"
+#include "sf.h"
+#include "rle.h"
 
 #define NBM 10
 
@@ -314,3 +317,155 @@ void ondelette_2d_inverse_tst()
 }
 
 
+
+/*
+ * Codage puis décodage d'une matrice entièrement en mémoire.
+ */
+
+static void ondelette_memoire_test(int hau, int lar, enum intstream_type type
+				   , int fenetre, int contextes)
+{
+  struct parametres_ondelette p ;
+  Matrice *m, *r ;
+  struct bitstream *bs ;
+  unsigned char *octets ;
+  size_t taille ;
+  int x, y ;
+
+  m = allocation_matrice_float(hau, lar) ;
+  r = allocation_matrice_float(hau, lar) ;
+  for(y=0; y<hau; y++)
+    for(x=0; x<lar; x++)
+      {
+	m->t[y][x] = (x*y) % 7 == 3 ? x - y : 0 ;
+	r->t[y][x] = 1234 ;
+      }
+
+  p.type = type ;
+  p.fenetre = fenetre ;
+  p.contextes = contextes ;
+  octets = NULL ;
+  taille = 0 ;
+  bs = open_bitstream_memory(&octets, &taille, "w") ;
+  codage_ondelette_bitstream(m, bs, &p) ;
+  close_bitstream(bs) ;
+
+  bs = open_bitstream_memory(&octets, &taille, "r") ;
+  decodage_ondelette_bitstream(r, bs, &p) ;
+  close_bitstream(bs) ;
+  free(octets) ;
+
+  for(y=0; y<hau; y++)
+    for(x=0; x<lar; x++)
+      if ( m->t[y][x] != r->t[y][x] )
+	{
+	  eprintf("Image %dx%d codée en mémoire"
+		  " (type %d, fenêtre %d, contextes %d)\n"
+		  , lar, hau, type, fenetre, contextes) ;
+	  eprintf("Pixel (%d,%d) vaut %g au lieu de %g\n"
+		  , x, y, r->t[y][x], m->t[y][x]) ;
+	  return ;
+	}
+  liberation_matrice_float(m) ;
+  liberation_matrice_float(r) ;
+}
+
+/*
+ * Avec Shannon-Fano et CONTEXTES=0 le flot doit être celui
+ * du codeur d'origine : pas de type au début,
+ * un seul modèle pour les longueurs et les valeurs.
+ */
+
+static void ondelette_format_origine_test(int hau, int lar)
+{
+  Matrice *m ;
+  struct bitstream *bs ;
+  struct shannon_fano *sf ;
+  struct intstream *entier, *entier_signe ;
+  struct parametres_ondelette p ;
+  unsigned char *octets, *origine ;
+  size_t taille, taille_origine ;
+  float *t, *pt ;
+  int x, y, h, l ;
+
+  m = allocation_matrice_float(hau, lar) ;
+  for(y=0; y<hau; y++)
+    for(x=0; x<lar; x++)
+      m->t[y][x] = (x*y) % 7 == 3 ? x - y : 0 ;
+
+  ALLOUER(t, hau*lar) ;
+  pt = t ;
+  h = hau ;
+  l = lar ;
+  while( h != 1 || l != 1 )
+    {
+      for(y=0; y<h; y++)
+	for(x=0; x<l; x++)
+	  if ( y>=(h+1)/2 || x>=(l+1)/2 )
+	    *pt++ = m->t[y][x] ;
+      h = (h+1)/2 ;
+      l = (l+1)/2 ;
+    }
+  *pt = m->t[0][0] ;
+
+  origine = NULL ;
+  taille_origine = 0 ;
+  bs = open_bitstream_memory(&origine, &taille_origine, "w") ;
+  sf = open_shannon_fano() ;
+  entier = open_intstream(bs, Shannon_fano, sf) ;
+  entier_signe = open_intstream(bs, Shannon_fano, sf) ;
+  compresse(entier, entier_signe, hau*lar, t) ;
+  close_intstream(entier) ;
+  close_intstream(entier_signe) ;
+  close_shannon_fano(sf) ;
+  close_bitstream(bs) ;
+
+  p.type = Shannon_fano ;
+  p.fenetre = 0 ;
+  p.contextes = 0 ;
+  octets = NULL ;
+  taille = 0 ;
+  bs = open_bitstream_memory(&octets, &taille, "w") ;
+  codage_ondelette_bitstream(m, bs, &p) ;
+  close_bitstream(bs) ;
+
+  if ( taille != taille_origine || memcmp(octets, origine, taille) )
+    eprintf("Image %dx%d : le format par défaut a changé\n", lar, hau) ;
+
+  free(octets) ;
+  free(origine) ;
+  free(t) ;
+  liberation_matrice_float(m) ;
+}
+
+void codage_ondelette_bitstream_tst()
+{
+  int contextes ;
+
+  ondelette_format_origine_test(1, 1) ;
+  ondelette_format_origine_test(64, 37) ;
+
+  for(contextes=0; contextes<3; contextes++)
+    {
+      ondelette_memoire_test(1, 1, Shannon_fano, 0, contextes) ;
+      ondelette_memoire_test(3, 5, Shannon_fano, 0, contextes) ;
+      ondelette_memoire_test(64, 37, Shannon_fano, 0, contextes) ;
+      ondelette_memoire_test(64, 37, Shannon_fano, 100, contextes) ;
+    }
+  ondelette_memoire_test(1, 1, Huffman, 0, 0) ;
+  ondelette_memoire_test(64, 37, Huffman, 0, 0) ;
+  ondelette_memoire_test(1, 1, Intervalle, 0, 0) ;
+  ondelette_memoire_test(64, 37, Intervalle, 0, 0) ;
+  ondelette_memoire_test(1, 1, Rans, 0, 0) ;
+  ondelette_memoire_test(64, 37, Rans, 0, 0) ;
+}
+
+void decodage_ondelette_bitstream_tst()
+{
+  ondelette_memoire_test(200, 300, Shannon_fano, 0, 0) ;
+  ondelette_memoire_test(200, 300, Shannon_fano, 0, 2) ;
+  ondelette_memoire_test(200, 300, Shannon_fano, 4096, 0) ;
+  ondelette_memoire_test(200, 300, Huffman, 0, 0) ;
+  ondelette_memoire_test(200, 300, Intervalle, 0, 0) ;
+  ondelette_memoire_test(200, 300, Rans, 0, 0) ;
+}
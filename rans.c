@@ -0,0 +1,344 @@
+/*
+ * rANS (range Asymmetric Numeral Systems) statique entrelacé.
+ *
+ * Comme pour Huffman, les valeurs sont stockées par blocs :
+ * on compte les occurrences, on les normalise pour que leur somme
+ * fasse 2^precision puis on écrit ces fréquences dans l'entête.
+ *
+ * L'état "x" d'un codeur rANS contient toute l'information déjà codée :
+ * coder un symbole de fréquence "f" et de début "d" donne
+ *        x' = (x / f) * 2^precision + x % f + d
+ * et les octets de poids faible sortent quand "x" devient trop grand.
+ * Le décodeur fait l'inverse dans l'ordre inverse : on code donc
+ * le bloc de la fin vers le début dans un tampon rempli à l'envers,
+ * pour que le décodeur le lise de manière habituelle.
+ *
+ * Il y a NB_ETATS états indépendants, la valeur "i" utilise
+ * l'état "i % NB_ETATS" : au décodage les calculs des différents états
+ * ne dépendent pas les uns des autres et le processeur les mène
+ * en parallèle. Le bloc est décodé d'un coup à la lecture de l'entête.
+ *
+ *    nombre de valeurs du bloc           (Exp-Golomb)
+ *    nombre de valeurs différentes       (Exp-Golomb)
+ *    precision - PRECISION_MIN           (Exp-Golomb)
+ *    la plus petite valeur               (32 bits)
+ *    les écarts entre valeurs - 1        (Exp-Golomb)
+ *    les fréquences - 1 sauf la dernière (Exp-Golomb)
+ *    nombre d'octets                     (Exp-Golomb)
+ *    les octets (cadrés)
+ *
+ * Le "bitstream" ne doit pas être partagé avec un autre codeur.
+ */
+
+#include <stdint.h>
+#include "bit.h"
+#include "bits.h"
+#include "entier.h"
+#include "rans.h"
+
+#define TAILLE_BLOC (1 << 16)
+#define NB_ETATS 4
+#define RANS_BAS (1u << 23)    /* L'état reste dans [RANS_BAS, 2^31[ */
+/*
+ * 2^precision vaut au moins 4 fois le nombre de symboles
+ * (sinon les symboles rares prennent la place des fréquents)
+ * sans dépasser 2^PRECISION_MAX >= TAILLE_BLOC.
+ */
+#define PRECISION_MIN 12
+#define PRECISION_MAX 16
+
+struct symbole
+ {
+  int valeur ;
+  unsigned int nb_occurrences ;
+  unsigned int frequence ;
+  unsigned int debut ;
+ } ;
+
+/*
+ * Une case par valeur de "x % 2^precision" :
+ * la valeur décodée, sa fréquence et la position dans son intervalle.
+ */
+
+struct case_rans
+ {
+  int valeur ;
+  unsigned int frequence ;
+  unsigned int ecart ;
+ } ;
+
+struct rans
+ {
+  int *valeurs ;                /* Le bloc écrit ou décodé */
+  int nb_valeurs ;
+  int lues ;                    /* Lecture : valeurs déjà rendues */
+  struct symbole *symboles ;    /* Triés par valeur */
+  int nb_symboles ;
+  int precision ;
+  struct case_rans *cases ;
+  unsigned char *octets ;
+  size_t taille_octets ;
+ } ;
+
+/*
+ * Au pire un symbole de fréquence 1 sort 2 octets
+ */
+
+#define TAILLE_OCTETS(NB) (2 * (size_t)(NB) + 4 * NB_ETATS)
+
+struct rans* open_rans()
+{
+  struct rans *r ;
+
+  ALLOUER(r, 1) ;
+  ALLOUER(r->valeurs, TAILLE_BLOC) ;
+  ALLOUER(r->symboles, TAILLE_BLOC) ;
+  r->taille_octets = TAILLE_OCTETS(TAILLE_BLOC) ;
+  ALLOUER(r->octets, r->taille_octets) ;
+  r->cases = NULL ;
+  r->nb_valeurs = 0 ;
+  r->lues = 0 ;
+  return r ;
+}
+
+void close_rans(struct rans *r)
+{
+  free(r->valeurs) ;
+  free(r->symboles) ;
+  free(r->cases) ;
+  free(r->octets) ;
+  free(r) ;
+}
+
+static int compare_entiers(const void *a, const void *b)
+{
+  int x = *(const int*)a, y = *(const int*)b ;
+
+  return x < y ? -1 : x > y ;
+}
+
+/*
+ * Fréquences proportionnelles aux occurrences, au moins 1,
+ * et de somme 2^precision : l'excès est retiré aux plus fréquents,
+ * le manque donné au plus fréquent.
+ */
+
+static void normalise(struct rans *r, int nb_valeurs)
+{
+  unsigned long total = 1ul << r->precision, somme = 0, f ;
+  int i, plus_grand = 0, modifie ;
+
+  for(i=0; i<r->nb_symboles; i++)
+    {
+      f = (unsigned long)r->symboles[i].nb_occurrences * total / nb_valeurs ;
+      r->symboles[i].frequence = f ? f : 1 ;
+      somme += r->symboles[i].frequence ;
+      if ( r->symboles[i].nb_occurrences
+	   > r->symboles[plus_grand].nb_occurrences )
+	plus_grand = i ;
+    }
+  if ( somme <= total )
+    r->symboles[plus_grand].frequence += total - somme ;
+  else
+    do
+      {
+	modifie = 0 ;
+	for(i=0; i<r->nb_symboles && somme > total; i++)
+	  if ( r->symboles[i].frequence > 1
+	       && r->symboles[i].frequence * 2 * r->nb_symboles >= total )
+	    {
+	      r->symboles[i].frequence-- ;
+	      somme-- ;
+	      modifie = 1 ;
+	    }
+	if ( !modifie )
+	  for(i=0; i<r->nb_symboles && somme > total; i++)
+	    if ( r->symboles[i].frequence > 1 )
+	      {
+		r->symboles[i].frequence-- ;
+		somme-- ;
+	      }
+      }
+    while( somme > total ) ;
+}
+
+static void calcule_debuts(struct rans *r)
+{
+  unsigned int debut = 0 ;
+  int i ;
+
+  for(i=0; i<r->nb_symboles; i++)
+    {
+      r->symboles[i].debut = debut ;
+      debut += r->symboles[i].frequence ;
+    }
+}
+
+/*
+ * Ecrit le bloc en cours (s'il n'est pas vide) dans le bitstream.
+ */
+
+void vide_rans(struct bitstream *bs, struct rans *r)
+{
+  int *tri, i, j ;
+  struct symbole *s, cle ;
+  uint32_t etats[NB_ETATS], *x, x_max ;
+  unsigned char *p, *fin ;
+
+  if ( r->nb_valeurs == 0 )
+    return ;
+
+  /* Les valeurs différentes et leurs occurrences */
+  ALLOUER(tri, r->nb_valeurs) ;
+  memcpy(tri, r->valeurs, r->nb_valeurs * sizeof(*tri)) ;
+  qsort(tri, r->nb_valeurs, sizeof(*tri), compare_entiers) ;
+  r->nb_symboles = 0 ;
+  for(i=0; i<r->nb_valeurs; i=j)
+    {
+      for(j=i+1; j<r->nb_valeurs && tri[j] == tri[i]; j++)
+	;
+      s = &r->symboles[r->nb_symboles++] ;
+      s->valeur = tri[i] ;
+      s->nb_occurrences = j - i ;
+    }
+  free(tri) ;
+  r->precision = nb_bits_utile(r->nb_symboles - 1) + 2 ;
+  if ( r->precision < PRECISION_MIN )
+    r->precision = PRECISION_MIN ;
+  if ( r->precision > PRECISION_MAX )
+    r->precision = PRECISION_MAX ;
+  normalise(r, r->nb_valeurs) ;
+  calcule_debuts(r) ;
+
+  /* Le codage, à l'envers */
+  for(i=0; i<NB_ETATS; i++)
+    etats[i] = RANS_BAS ;
+  fin = p = r->octets + r->taille_octets ;
+  for(i=r->nb_valeurs-1; i>=0; i--)
+    {
+      cle.valeur = r->valeurs[i] ;
+      s = bsearch(&cle, r->symboles, r->nb_symboles, sizeof(*s)
+		  , compare_entiers) ;
+      x = &etats[i % NB_ETATS] ;
+      x_max = ((RANS_BAS >> r->precision) << 8) * s->frequence ;
+      while( *x >= x_max )
+	{
+	  *--p = *x ;
+	  *x >>= 8 ;
+	}
+      *x = ((*x / s->frequence) << r->precision) + *x % s->frequence
+	+ s->debut ;
+    }
+  for(i=NB_ETATS-1; i>=0; i--)
+    for(j=0; j<32; j+=8)
+      *--p = etats[i] >> j ;
+
+  /* L'entête puis les octets */
+  put_exp_golomb(bs, r->nb_valeurs - 1) ;
+  put_exp_golomb(bs, r->nb_symboles - 1) ;
+  put_exp_golomb(bs, r->precision - PRECISION_MIN) ;
+  put_bits(bs, 32, (unsigned int)r->symboles[0].valeur) ;
+  for(i=1; i<r->nb_symboles; i++)
+    put_exp_golomb(bs, (unsigned int)r->symboles[i].valeur
+		   - (unsigned int)r->symboles[i-1].valeur - 1) ;
+  for(i=0; i<r->nb_symboles-1; i++)
+    put_exp_golomb(bs, r->symboles[i].frequence - 1) ;
+  put_exp_golomb(bs, fin - p) ;
+  put_octets(bs, p, fin - p) ;
+  r->nb_valeurs = 0 ;
+}
+
+void put_entier_rans(struct bitstream *bs, struct rans *r, int evenement)
+{
+  r->valeurs[r->nb_valeurs++] = evenement ;
+  if ( r->nb_valeurs == TAILLE_BLOC )
+    vide_rans(bs, r) ;
+}
+
+/*
+ * Lit l'entête d'un bloc, ses octets et décode toutes ses valeurs.
+ * Un bloc corrompu ne doit pas faire lire après ses "nb_octets" octets :
+ * le rechargement de l'état (rare) teste la fin "fin".
+ */
+
+#define DECODE(K)							\
+  do									\
+    {									\
+      c = &r->cases[etats[K] & masque] ;				\
+      r->valeurs[i + (K)] = c->valeur ;					\
+      etats[K] = c->frequence * (etats[K] >> r->precision) + c->ecart ;	\
+      while( etats[K] < RANS_BAS )					\
+	{								\
+	  if ( p == fin )						\
+	    EXIT ;							\
+	  etats[K] = (etats[K] << 8) | *p++ ;				\
+	}								\
+    }									\
+  while(0)
+
+static void lit_bloc(struct bitstream *bs, struct rans *r)
+{
+  int i, k ;
+  unsigned int j, somme, masque ;
+  size_t nb_octets ;
+  uint32_t etats[NB_ETATS] ;
+  const unsigned char *p, *fin ;
+  const struct case_rans *c ;
+
+  r->nb_valeurs = get_exp_golomb(bs) + 1 ;
+  r->nb_symboles = get_exp_golomb(bs) + 1 ;
+  r->precision = get_exp_golomb(bs) + PRECISION_MIN ;
+  if ( r->nb_valeurs > TAILLE_BLOC || r->nb_symboles > r->nb_valeurs
+       || r->precision > PRECISION_MAX )
+    EXIT ;
+  r->symboles[0].valeur = get_bits(bs, 32) ;
+  for(i=1; i<r->nb_symboles; i++)
+    r->symboles[i].valeur = (unsigned int)r->symboles[i-1].valeur
+      + get_exp_golomb(bs) + 1 ;
+  somme = 0 ;
+  for(i=0; i<r->nb_symboles-1; i++)
+    {
+      r->symboles[i].frequence = get_exp_golomb(bs) + 1 ;
+      somme += r->symboles[i].frequence ;
+    }
+  if ( somme >= 1u << r->precision )
+    EXIT ;
+  r->symboles[i].frequence = (1u << r->precision) - somme ;
+  calcule_debuts(r) ;
+
+  free(r->cases) ;
+  ALLOUER(r->cases, 1 << r->precision) ;
+  for(i=0; i<r->nb_symboles; i++)
+    for(j=0; j<r->symboles[i].frequence; j++)
+      r->cases[r->symboles[i].debut + j] = (struct case_rans)
+	{ r->symboles[i].valeur, r->symboles[i].frequence, j } ;
+
+  nb_octets = get_exp_golomb(bs) ;
+  if ( nb_octets > r->taille_octets || nb_octets < 4 * NB_ETATS )
+    EXIT ;
+  get_octets(bs, r->octets, nb_octets) ;
+
+  /* Le décodage, NB_ETATS valeurs à la fois */
+  p = r->octets ;
+  fin = r->octets + nb_octets ;
+  for(k=0; k<NB_ETATS; k++, p+=4)
+    etats[k] = (uint32_t)p[0] << 24 | p[1] << 16 | p[2] << 8 | p[3] ;
+  masque = (1u << r->precision) - 1 ;
+  for(i=0; i + NB_ETATS <= r->nb_valeurs; i += NB_ETATS)
+    {
+      DECODE(0) ;
+      DECODE(1) ;
+      DECODE(2) ;
+      DECODE(3) ;
+    }
+  for(k=0; i + k < r->nb_valeurs; k++)
+    DECODE(k) ;
+  r->lues = 0 ;
+}
+
+int get_entier_rans(struct bitstream *bs, struct rans *r)
+{
+  if ( r->lues == r->nb_valeurs )
+    lit_bloc(bs, r) ;
+  return r->valeurs[r->lues++] ;
+}
@@ -0,0 +1,18 @@
+/*
+ * rANS statique entrelacé
+ */
+
+#ifndef _HOME_EXCO_REDACTEX_COURS_TRANS_COMP_IMAGE_TP_DCT2_RANS_H
+#define _HOME_EXCO_REDACTEX_COURS_TRANS_COMP_IMAGE_TP_DCT2_RANS_H
+
+#include "bitstream.h"
+
+struct rans ;
+
+struct rans* open_rans() ;
+void close_rans(struct rans *r) ;
+void put_entier_rans(struct bitstream *bs, struct rans *r, int evenement) ;
+void vide_rans(struct bitstream *bs, struct rans *r) ;
+int get_entier_rans(struct bitstream *bs, struct rans *r) ;
+
+#endif
@@ -0,0 +1,185 @@
+#include <limits.h>
+#include <signal.h>
+#include <sys/wait.h>
+#include "rans.h"
+#include "entier.h"
+#include "bits.h"
+
+/*
+ * Ecrit "nb" valeurs de "valeur(i)" en mémoire, les relit
+ * et retourne la taille en octets (-1 si une valeur est mal lue).
+ */
+
+static int rans_test(int nb, int (*valeur)(int))
+{
+  struct rans *r ;
+  struct bitstream *bs ;
+  unsigned char *octets ;
+  size_t taille ;
+  int i, v ;
+
+  octets = NULL ;
+  taille = 0 ;
+  r = open_rans() ;
+  bs = open_bitstream_memory(&octets, &taille, "w") ;
+  for(i=0; i<nb; i++)
+    put_entier_rans(bs, r, valeur(i)) ;
+  vide_rans(bs, r) ;
+  close_bitstream(bs) ;
+  close_rans(r) ;
+
+  r = open_rans() ;
+  bs = open_bitstream_memory(&octets, &taille, "r") ;
+  for(i=0; i<nb; i++)
+    {
+      v = get_entier_rans(bs, r) ;
+      if ( v != valeur(i) )
+	{
+	  eprintf("%d valeurs : la valeur %d vaut %d au lieu de %d\n"
+		  , nb, i, v, valeur(i)) ;
+	  taille = -1 ;
+	  break ;
+	}
+    }
+  close_bitstream(bs) ;
+  close_rans(r) ;
+  free(octets) ;
+  return taille ;
+}
+
+static int nulle(int i)
+{
+  return 0 ;
+}
+
+static int biaisee(int i)
+{
+  return i % 5 ? (i % 3) : (i * 7919) % 3001 - 1500 ;
+}
+
+static int extremes(int i)
+{
+  switch(i % 4)
+    {
+    case 0: return INT_MIN ;
+    case 1: return INT_MAX ;
+    case 2: return 0 ;
+    default: return i ;
+    }
+}
+
+/* Plus de 2^12 valeurs différentes dans un bloc */
+static int differentes(int i)
+{
+  return i % 3 ? 5 : i * 11 ;
+}
+
+void open_rans_tst()
+{
+  struct rans *r ;
+
+  r = open_rans() ;
+  if ( r == NULL )
+    {
+      eprintf("Elle retourne NULL !\n") ;
+      return ;
+    }
+  close_rans(r) ;
+}
+
+void close_rans_tst()
+{
+  if ( rans_test(0, nulle) != 0 )
+    eprintf("Aucune valeur ne doit rien écrire\n") ;
+}
+
+void put_entier_rans_tst()
+{
+  int t ;
+
+  /* Moins d'un bit par valeur : impossible avec Huffman */
+  t = rans_test(60000, nulle) ;
+  if ( t < 0 )
+    return ;
+  if ( t > 100 )
+    {
+      eprintf("60000 valeurs nulles prennent %d octets\n", t) ;
+      return ;
+    }
+  t = rans_test(100000, biaisee) ;
+  if ( t < 0 )
+    return ;
+  if ( t > 100000 * 5 / 8 )
+    {
+      eprintf("Le codage est trop long : %d octets\n", t) ;
+      return ;
+    }
+}
+
+void vide_rans_tst()
+{
+  int i ;
+
+  /* Tous les restes de la division par le nombre d'états */
+  for(i=1; i<=9; i++)
+    if ( rans_test(i, biaisee) < 0 )
+      return ;
+}
+
+/*
+ * Un bloc écrit à la main : 100 valeurs de deux symboles
+ * de même fréquence et 16 octets nuls. Les états nuls restent nuls,
+ * le décodeur veut recharger sans fin : il doit s'arrêter (EXIT)
+ * à la fin des octets du bloc au lieu de lire au delà.
+ */
+
+static int bloc_nul_arrete()
+{
+  struct rans *r ;
+  struct bitstream *bs ;
+  unsigned char *octets ;
+  size_t taille ;
+  int i, status ;
+
+  octets = NULL ;
+  taille = 0 ;
+  bs = open_bitstream_memory(&octets, &taille, "w") ;
+  put_exp_golomb(bs, 100 - 1) ;	/* Nombre de valeurs */
+  put_exp_golomb(bs, 2 - 1) ;	/* Nombre de symboles */
+  put_exp_golomb(bs, 0) ;	/* Précision minimale */
+  put_bits(bs, 32, 0) ;		/* Première valeur */
+  put_exp_golomb(bs, 0) ;	/* Ecart */
+  put_exp_golomb(bs, 2048 - 1) ; /* Fréquence du premier symbole */
+  put_exp_golomb(bs, 16) ;	/* Nombre d'octets */
+  align_bitstream(bs) ;
+  for(i=0; i<16; i++)
+    put_bits(bs, 8, 0) ;
+  close_bitstream(bs) ;
+
+  if ( fork() == 0 )
+    {
+      close(2) ;
+      r = open_rans() ;
+      bs = open_bitstream_memory_read(octets, taille) ;
+      get_entier_rans(bs, r) ;
+      exit(0) ;
+    }
+  wait(&status) ;
+  free(octets) ;
+  return WIFSIGNALED(status) && WTERMSIG(status) == SIGABRT ;
+}
+
+void get_entier_rans_tst()
+{
+  if ( rans_test(1000, extremes) < 0 )
+    return ;
+  if ( rans_test(200000, biaisee) < 0 )
+    return ;
+  if ( rans_test(65536, differentes) < 0 )
+    return ;
+  if ( !bloc_nul_arrete() )
+    {
+      eprintf("Un bloc corrompu fait lire après ses octets\n") ;
+      return ;
+    }
+}
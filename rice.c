@@ -0,0 +1,105 @@
+/*
+ * Codage de Golomb-Rice adaptatif pour les entiers positifs
+ * (les longueurs des suites de 0 de la RLE, à peu près géométriques).
+ *
+ * Avec le paramètre "k", l'entier "v" est codé par "v >> k" bits à 0,
+ * un bit à 1, puis les "k" bits de poids faible de "v".
+ * Le meilleur "k" est à peu près le logarithme de la moyenne :
+ * c'est le plus petit "k" tel que "nb << k >= somme" où "somme"
+ * et "nb" sont la somme et le nombre des valeurs déjà codées
+ * (divisés par 2 tous les NB_OUBLI valeurs pour suivre les changements).
+ * Il n'y a aucune table : quelques décalages par valeur.
+ *
+ * Si "v >> k" atteint LIMITE, on écrit LIMITE bits à 0
+ * suivis des 32 bits de "v".
+ */
+
+#include "bits.h"
+#include "rice.h"
+
+#define LIMITE 16
+#define NB_OUBLI 64
+#define K_MAX 30
+
+struct rice
+ {
+  unsigned long somme ;
+  unsigned int nb ;
+  int k ;
+ } ;
+
+struct rice* open_rice()
+{
+  struct rice *r ;
+
+  ALLOUER(r, 1) ;
+  r->somme = 2 ;
+  r->nb = 1 ;
+  r->k = 1 ;
+  return r ;
+}
+
+void close_rice(struct rice *r)
+{
+  free(r) ;
+}
+
+static void mise_a_jour(struct rice *r, unsigned int v)
+{
+  r->somme += v ;
+  if ( ++r->nb == NB_OUBLI )
+    {
+      r->somme >>= 1 ;
+      r->nb >>= 1 ;
+    }
+  for(r->k = 0; r->k < K_MAX && ((unsigned long)r->nb << r->k) < r->somme
+	; r->k++)
+    ;
+}
+
+void put_entier_rice(struct bitstream *bs, struct rice *r, int evenement)
+{
+  unsigned int v = evenement, q ;
+
+  if ( evenement < 0 )
+    EXIT ;
+  q = v >> r->k ;
+  if ( q < LIMITE )
+    put_bits(bs, q + 1 + r->k, (1ul << r->k) | (v & ((1u << r->k) - 1))) ;
+  else
+    {
+      put_bits(bs, LIMITE, 0) ;
+      put_bits(bs, 32, v) ;
+    }
+  mise_a_jour(r, v) ;
+}
+
+int get_entier_rice(struct bitstream *bs, struct rice *r)
+{
+  unsigned int w, q, v ;
+
+  w = peek_bits(bs, LIMITE) ;
+  if ( w == 0 )
+    {
+      skip_bits(bs, LIMITE) ;
+      v = get_bits(bs, 32) ;
+    }
+  else
+    {
+      for(q=0; !(w & (1u << (LIMITE - 1 - q))); q++)
+	;
+      v = get_bits(bs, q + 1 + r->k) & ((1ul << r->k) - 1) ;
+      v |= q << r->k ;
+    }
+  mise_a_jour(r, v) ;
+  return v ;
+}
+
+/*
+ * Fonctions pour les tests, NE PAS MODIFIER
+ */
+
+int rice_get_k(const struct rice *r)
+{
+  return r->k ;
+}
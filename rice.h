@@ -0,0 +1,21 @@
+/*
+ * Codage de Golomb-Rice adaptatif (entiers positifs)
+ */
+
+#ifndef _HOME_EXCO_REDACTEX_COURS_TRANS_COMP_IMAGE_TP_DCT2_RICE_H
+#define _HOME_EXCO_REDACTEX_COURS_TRANS_COMP_IMAGE_TP_DCT2_RICE_H
+
+#include "bitstream.h"
+
+struct rice ;
+
+struct rice* open_rice() ;
+void close_rice(struct rice *r) ;
+void put_entier_rice(struct bitstream *bs, struct rice *r, int evenement) ;
+int get_entier_rice(struct bitstream *bs, struct rice *r) ;
+
+/* Pour les tests */
+
+int rice_get_k(const struct rice *r) ; /**/
+
+#endif
@@ -0,0 +1,126 @@
+#include <limits.h>
+#include "rice.h"
+#include "entier.h"
+
+/*
+ * Suite à peu près géométrique de moyenne "moyenne"
+ */
+
+static int geometrique(int i, int moyenne)
+{
+  unsigned int h = i * 2654435761u ;
+  int v = 0 ;
+
+  while( (h >> 16) % (moyenne + 1) != 0 && v < 100 * moyenne )
+    {
+      v++ ;
+      h = h * 1103515245u + 12345 ;
+    }
+  return v ;
+}
+
+static int valeur_rice(int i)
+{
+  if ( i % 1000 == 999 )
+    return i % 2000 == 999 ? INT_MAX : 1 << 20 ;
+  return geometrique(i, i < 5000 ? 2 : 300) ;
+}
+
+void open_rice_tst()
+{
+  struct rice *r ;
+
+  r = open_rice() ;
+  if ( r == NULL )
+    {
+      eprintf("Elle retourne NULL !\n") ;
+      return ;
+    }
+  if ( rice_get_k(r) != 1 )
+    {
+      eprintf("Le paramètre initial doit être 1\n") ;
+      return ;
+    }
+  close_rice(r) ;
+}
+
+void close_rice_tst()
+{
+  close_rice(open_rice()) ;
+}
+
+void put_entier_rice_tst()
+{
+  struct rice *r ;
+  struct bitstream *bs, *bs_entier ;
+  unsigned char *octets = NULL, *octets_entier = NULL ;
+  size_t taille = 0, taille_entier = 0 ;
+  int i ;
+
+  /* Le paramètre suit la moyenne */
+  r = open_rice() ;
+  bs = open_bitstream_memory(&octets, &taille, "w") ;
+  bs_entier = open_bitstream_memory(&octets_entier, &taille_entier, "w") ;
+  for(i=0; i<1000; i++)
+    {
+      put_entier_rice(bs, r, geometrique(i, 2)) ;
+      put_entier(bs_entier, geometrique(i, 2)) ;
+    }
+  if ( rice_get_k(r) > 2 )
+    {
+      eprintf("Moyenne 2 : k vaut %d\n", rice_get_k(r)) ;
+      return ;
+    }
+  for(i=0; i<1000; i++)
+    {
+      put_entier_rice(bs, r, geometrique(i, 300)) ;
+      put_entier(bs_entier, geometrique(i, 300)) ;
+    }
+  if ( rice_get_k(r) < 7 || rice_get_k(r) > 9 )
+    {
+      eprintf("Moyenne 300 : k vaut %d\n", rice_get_k(r)) ;
+      return ;
+    }
+  close_bitstream(bs) ;
+  close_bitstream(bs_entier) ;
+  close_rice(r) ;
+  if ( taille >= taille_entier )
+    {
+      eprintf("Rice : %d octets, put_entier : %d octets\n"
+	      , (int)taille, (int)taille_entier) ;
+      return ;
+    }
+  free(octets) ;
+  free(octets_entier) ;
+}
+
+void get_entier_rice_tst()
+{
+  struct rice *r ;
+  struct bitstream *bs ;
+  unsigned char *octets = NULL ;
+  size_t taille = 0 ;
+  int i, v ;
+
+  r = open_rice() ;
+  bs = open_bitstream_memory(&octets, &taille, "w") ;
+  for(i=0; i<10000; i++)
+    put_entier_rice(bs, r, valeur_rice(i)) ;
+  close_bitstream(bs) ;
+  close_rice(r) ;
+
+  r = open_rice() ;
+  bs = open_bitstream_memory(&octets, &taille, "r") ;
+  for(i=0; i<10000; i++)
+    {
+      v = get_entier_rice(bs, r) ;
+      if ( v != valeur_rice(i) )
+	{
+	  eprintf("La valeur %d vaut %d au lieu de %d\n", i, v, valeur_rice(i)) ;
+	  return ;
+	}
+    }
+  close_bitstream(bs) ;
+  close_rice(r) ;
+  free(octets) ;
+}
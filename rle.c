@@ -1,6 +1,9 @@
 #include "bases.h"
 #include "intstream.h"
 #include "rle.h"
+#include "bit.h"
+#include "bits.h"
+#include "exception.h"
 
 /*
  * Avant propos sur les "intstream"
@@ -36,6 +39,50 @@
  *     (0,5) (0,8) (2,4) (4,2) (0,1) (3)
  */
 
+/*
+ * Position du premier coefficient à partir de "i" qui ne s'arrondit
+ * pas à 0 ("nbe" s'il n'y en a pas).
+ * "rint" arrondit au pair le plus proche : rint(x) vaut 0
+ * si et seulement si |x| <= 0.5, il suffit donc d'une comparaison.
+ * Avec SSE2 (ou AVX) on compare 4 (ou 8) coefficients d'un coup,
+ * le masque des non nuls donne directement la position du premier.
+ */
+
+#if defined(__AVX__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+static int prochain_non_nul(const float *dct, int i, int nbe)
+{
+#if defined(__AVX__)
+	const __m256 signe = _mm256_set1_ps(-0.f);
+	const __m256 demi = _mm256_set1_ps(0.5f);
+	int masque;
+	for ( ; i + 8 <= nbe; i += 8) {
+		masque = _mm256_movemask_ps(
+			_mm256_cmp_ps(_mm256_andnot_ps(signe, _mm256_loadu_ps(dct + i))
+				      , demi, _CMP_GT_OQ));
+		if (masque)
+			return i + __builtin_ctz(masque);
+	}
+#elif defined(__SSE2__)
+	const __m128 signe = _mm_set1_ps(-0.f);
+	const __m128 demi = _mm_set1_ps(0.5f);
+	int masque;
+	for ( ; i + 4 <= nbe; i += 4) {
+		masque = _mm_movemask_ps(
+			_mm_cmpgt_ps(_mm_andnot_ps(signe, _mm_loadu_ps(dct + i))
+				     , demi));
+		if (masque)
+			return i + __builtin_ctz(masque);
+	}
+#endif
+	for ( ; i < nbe; i++)
+		if (fabsf(dct[i]) > 0.5f)
+			return i;
+	return nbe;
+}
+
 /*
  * Stocker le tableau de flottant dans les deux "instream"
  * En perdant le moins d'information possible.
@@ -44,25 +91,35 @@
 void compresse(struct intstream *entier, struct intstream *entier_signe
 	       , int nbe, const float *dct)
 {
-	int count_zero = 0;
-	int val;
-	for (int i=0; i<nbe; ++i) {
-		//arrondir à l'entier le plus proche
-		val = rint(dct[i]);
-
-		if (val != 0) {
-			//Stocker le nombre de 0
-			put_entier_intstream(entier, count_zero);
-			count_zero = 0;
-			//Stocker l'entier
-			put_entier_intstream(entier_signe, val);
-		}
-		else
-			count_zero++; //On peut le faire systématiquement, est ce mieux au niveau du pipeline?
+	int debut = 0;
+	int i;
+	//On saute directement d'un coefficient non nul au suivant
+	for (i = prochain_non_nul(dct, 0, nbe); i < nbe;
+	     i = prochain_non_nul(dct, debut, nbe)) {
+		//Stocker le nombre de 0
+		put_entier_intstream(entier, i - debut);
+		//Stocker l'entier arrondi
+		put_entier_intstream(entier_signe, rint(dct[i]));
+		debut = i + 1;
 	}
 	//S'il reste des 0 non écrits, on les écrits
-	if (count_zero)
-		put_entier_intstream(entier, count_zero);
+	if (debut != nbe)
+		put_entier_intstream(entier, nbe - debut);
+}
+
+/*
+ * Un flot corrompu peut donner une longueur de suite de 0
+ * négative ou qui dépasse les "reste" places du tableau :
+ * on arrête avant le "memset".
+ */
+
+static void verifie_zeros(int count_zero, int reste)
+{
+	if (count_zero < 0 || count_zero > reste) {
+		fprintf(stderr, "RLE : suite de %d zéros pour %d places\n"
+			, count_zero, reste);
+		EXIT;
+	}
 }
 
 /*
@@ -74,14 +131,15 @@ void decompresse(struct intstream *entier, struct intstream *entier_signe
 {
 	
 	int count_val = 0;
-	int count_zero, i;
+	int count_zero;
 	while(count_val != nbe) {
 
 		//On lit le nombre de 0
 		count_zero = get_entier_intstream(entier);
-		//On met autant de 0 dans le tableau
-		for (i=0; i<count_zero; ++i)
-			dct[count_val++] = 0;
+		verifie_zeros(count_zero, nbe - count_val);
+		//On met autant de 0 dans le tableau (les bits d'un 0 flottant sont nuls)
+		memset(dct + count_val, 0, count_zero * sizeof(*dct));
+		count_val += count_zero;
 
 		//On peut finir sur des 0
 		if (count_val == nbe)
@@ -92,3 +150,137 @@ void decompresse(struct intstream *entier, struct intstream *entier_signe
 	}
 
 }
+
+/*
+ * Même chose mais avec un couple d'"intstream" par bande :
+ * "bande[i]" donne la bande de la position "i" dans le tableau
+ * (fréquence de la DCT ou niveau de l'ondelette).
+ * Chaque bande a ainsi son propre modèle pour les longueurs
+ * des suites de 0 et pour les valeurs.
+ *
+ * Une longueur est codée dans la bande de la position où commence
+ * la suite de 0, le décodeur connaît cette position avant de la lire.
+ */
+
+void compresse_bandes(struct intstream **entier
+		      , struct intstream **entier_signe
+		      , const int *bande, int nbe, const float *dct)
+{
+	int debut = 0;
+	int i;
+	for (i = prochain_non_nul(dct, 0, nbe); i < nbe;
+	     i = prochain_non_nul(dct, debut, nbe)) {
+		put_entier_intstream(entier[bande[debut]], i - debut);
+		put_entier_intstream(entier_signe[bande[i]], rint(dct[i]));
+		debut = i + 1;
+	}
+	if (debut != nbe)
+		put_entier_intstream(entier[bande[debut]], nbe - debut);
+}
+
+void decompresse_bandes(struct intstream **entier
+			, struct intstream **entier_signe
+			, const int *bande, int nbe, float *dct)
+{
+	int count_val = 0;
+	int count_zero;
+	while(count_val != nbe) {
+		count_zero = get_entier_intstream(entier[bande[count_val]]);
+		verifie_zeros(count_zero, nbe - count_val);
+		memset(dct + count_val, 0, count_zero * sizeof(*dct));
+		count_val += count_zero;
+
+		if (count_val == nbe)
+			break;
+
+		dct[count_val] = get_entier_intstream(entier_signe[bande[count_val]]);
+		count_val++;
+	}
+}
+
+/*
+ * Codage joint à la JPEG : chaque valeur non nulle donne un seul
+ * symbole, codé par l'"intstream", qui contient la longueur de la
+ * suite de 0 qui la précède et sa catégorie (son nombre de bits) :
+ *      symbole = longueur * NB_CATEGORIES + catégorie
+ * Il est suivi directement dans le "bitstream" du signe de la valeur
+ * puis des bits de sa valeur absolue sans le bit de poids fort.
+ * Si le tableau finit par des 0, ils sont remplacés par le symbole
+ * FIN_DE_BLOC (longueur 0 et catégorie 0 ne peuvent pas coder une valeur).
+ *
+ * FIN_DE_BLOC étant très fréquent, son code peut être fait des bits
+ * de remplissage du dernier octet : "termine_joint" écrit donc
+ * FIN_DE_FLOT après le dernier tableau, le décodeur lance alors
+ * l'exception "Exception_fichier_lecture" comme en fin de fichier.
+ *
+ * L'"intstream" doit donc écrire directement dans le "bitstream"
+ * (Entier, Shannon_fano mais pas Huffman, Intervalle ou Rans).
+ * Si "bande" n'est pas NULL, le symbole est codé dans l'"intstream"
+ * de la bande où commence la suite de 0 (voir "compresse_bandes").
+ */
+
+#define NB_CATEGORIES 64
+#define FIN_DE_BLOC 0
+#define FIN_DE_FLOT NB_CATEGORIES
+
+void compresse_joint(struct intstream **symbole, struct bitstream *bs
+		     , const int *bande, int nbe, const float *dct)
+{
+	int debut = 0;
+	int i, val, categorie;
+	unsigned int absolue;
+	for (i = prochain_non_nul(dct, 0, nbe); i < nbe;
+	     i = prochain_non_nul(dct, debut, nbe)) {
+		val = rint(dct[i]);
+		absolue = val < 0 ? -(unsigned int)val : (unsigned int)val;
+		categorie = nb_bits_utile(absolue);
+		put_entier_intstream(symbole[bande ? bande[debut] : 0]
+				     , (i - debut) * NB_CATEGORIES + categorie);
+		put_bits(bs, categorie
+			 , (unsigned long)(val < 0) << (categorie - 1)
+			 | (absolue & ((1ul << (categorie - 1)) - 1)));
+		debut = i + 1;
+	}
+	if (debut != nbe)
+		put_entier_intstream(symbole[bande ? bande[debut] : 0]
+				     , FIN_DE_BLOC);
+}
+
+void decompresse_joint(struct intstream **symbole, struct bitstream *bs
+		       , const int *bande, int nbe, float *dct)
+{
+	int count_val = 0;
+	int s, count_zero, categorie;
+	unsigned long bits, absolue;
+	while(count_val != nbe) {
+		s = get_entier_intstream(symbole[bande ? bande[count_val] : 0]);
+		if (s == FIN_DE_FLOT)
+			EXCEPTION_LANCE(Exception_fichier_lecture);
+		if (s == FIN_DE_BLOC) {
+			memset(dct + count_val, 0, (nbe - count_val) * sizeof(*dct));
+			break;
+		}
+		count_zero = s / NB_CATEGORIES;
+		categorie = s % NB_CATEGORIES;
+		//Catégorie 0 : seuls FIN_DE_BLOC et FIN_DE_FLOT existent
+		if (categorie == 0) {
+			fprintf(stderr, "RLE : symbole %d invalide\n", s);
+			EXIT;
+		}
+		//La suite de 0 est suivie d'une valeur
+		verifie_zeros(count_zero, nbe - count_val - 1);
+		memset(dct + count_val, 0, count_zero * sizeof(*dct));
+		count_val += count_zero;
+
+		bits = get_bits(bs, categorie);
+		absolue = (1ul << (categorie - 1))
+			| (bits & ((1ul << (categorie - 1)) - 1));
+		dct[count_val++] = bits >> (categorie - 1) ? -(double)absolue
+			: (double)absolue;
+	}
+}
+
+void termine_joint(struct intstream **symbole, const int *bande)
+{
+	put_entier_intstream(symbole[bande ? bande[0] : 0], FIN_DE_FLOT);
+}
@@ -6,9 +6,15 @@
 #define _HOME_EXCO_REDACTEX_COURS_TRANS_COMP_IMAGE_TP_DCT2_RLE_H
 
 struct intstream ;
+struct bitstream ;
 
 void compresse(struct intstream *entier, struct intstream *entier_signe, int nbe, const float *dct) ;
 void decompresse(struct intstream *entier, struct intstream *entier_signe, int nbe, float *dct) ;
+void compresse_bandes(struct intstream **entier, struct intstream **entier_signe, const int *bande, int nbe, const float *dct) ;
+void decompresse_bandes(struct intstream **entier, struct intstream **entier_signe, const int *bande, int nbe, float *dct) ;
+void compresse_joint(struct intstream **symbole, struct bitstream *bs, const int *bande, int nbe, const float *dct) ;
+void decompresse_joint(struct intstream **symbole, struct bitstream *bs, const int *bande, int nbe, float *dct) ;
+void termine_joint(struct intstream **symbole, const int *bande) ;
 
 
 #endif
@@ -2,6 +2,13 @@
 #include "rle.h"
 #include "bitstream.h"
 #include "intstream.h"
+#include "sf.h"
+#include "bits.h"
+#include "exception.h"
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <sys/wait.h>
 
 void compresse_test(int nb_t, float *t, int nb_ok, int *ok)
 {
@@ -48,6 +55,47 @@ void compresse_test(int nb_t, float *t, int nb_ok, int *ok)
     }
 }
 
+/*
+ * Même vérification quand les longueurs et les valeurs sont
+ * dans un seul "intstream" (Huffman).
+ */
+
+static void compresse_un_intstream_test(int nb_t, float *t, int nb_ok, int *ok)
+{
+  struct intstream *is ;
+  struct bitstream *bs ;
+  unsigned char *octets ;
+  size_t taille ;
+  int lu[nb_ok + 1] ;
+  int i ;
+
+  octets = NULL ;
+  taille = 0 ;
+  bs = open_bitstream_memory(&octets, &taille, "w") ;
+  is = open_intstream(bs, Huffman, NULL) ;
+  compresse(is, is, nb_t, t) ;
+  put_entier_intstream(is, -123) ;
+  close_intstream(is) ;
+  close_bitstream(bs) ;
+
+  bs = open_bitstream_memory(&octets, &taille, "r") ;
+  is = open_intstream(bs, Huffman, NULL) ;
+  for(i=0; i<nb_ok + 1; i++)
+    lu[i] = get_entier_intstream(is) ;
+  close_intstream(is) ;
+  close_bitstream(bs) ;
+  free(octets) ;
+  for(i=0; i<nb_ok; i++)
+    if ( lu[i] != ok[i] )
+      {
+	eprintf("Un seul intstream : pour l'entier %d, j'attendais %d\n"
+		, i, ok[i]) ;
+	return ;
+      }
+  if ( lu[nb_ok] != -123 )
+    eprintf("Un seul intstream : un entier de trop a été stocké\n") ;
+}
+
 void compresse_tst()
 {
   static float t1[] = { 0, 0, 5 } ;
@@ -55,13 +103,212 @@ void compresse_tst()
 
   static float t2[] = { -0.4, -0.9, 0, 0.4, 0.9, 2    , 0,0,0 } ;
   static int  ok2[] = {      1,-1,          2,1, 0,2,        3 } ;
+  int i ;
+
+  /*
+   * Valeurs autour de 0.5 et longues suites de 0 qui ne sont pas
+   * alignées : "compresse" ne fait pas l'arrondi de chaque valeur.
+   */
+  {
+    static const float bords[] = { 0.5, -0.5, 0.50001, -0.50001, 1.5, -2.5
+				   , 0.49, 1000.5, -0.0 } ;
+    float t4[1003] ;
+    int ok4[2*1003+1], nb, zeros ;
+
+    for(i=0; i<TAILLE(t4); i++)
+      t4[i] = (i*i) % 97 == 3 ? bords[i % TAILLE(bords)] : 0.3 ;
+    nb = zeros = 0 ;
+    for(i=0; i<TAILLE(t4); i++)
+      if ( rint(t4[i]) )
+	{
+	  ok4[nb++] = zeros ;
+	  ok4[nb++] = rint(t4[i]) ;
+	  zeros = 0 ;
+	}
+      else
+	zeros++ ;
+    if ( zeros )
+      ok4[nb++] = zeros ;
+    compresse_test(TAILLE(t4), t4, nb, ok4) ;
+    compresse_un_intstream_test(TAILLE(t4), t4, nb, ok4) ;
+  }
 
   compresse_test(TAILLE(t1), t1, TAILLE(ok1), ok1) ;
+  /* "decompresse_tst" relit le fichier "xxx" : ce test doit être le dernier */
   compresse_test(TAILLE(t2), t2, TAILLE(ok2), ok2) ;
+  compresse_un_intstream_test(TAILLE(t1), t1, TAILLE(ok1), ok1) ;
+  compresse_un_intstream_test(TAILLE(t2), t2, TAILLE(ok2), ok2) ;
+
+  /* Un long tableau dans un seul "intstream" */
+  {
+    float t3[1000] ;
+    int ok3[1000] ;
+
+    for(i=0; i<TAILLE(t3); i+=2)
+      {
+	t3[i] = 0 ;
+	t3[i+1] = i - 500 + 1 ;
+	ok3[i] = 1 ;
+	ok3[i+1] = i - 500 + 1 ;
+      }
+    compresse_un_intstream_test(TAILLE(t3), t3, TAILLE(ok3), ok3) ;
+  }
 
   return ;
 }
 
+/*
+ * Décode un tableau de 8 valeurs dont les entiers (codés avec Entier)
+ * sont "symboles", dans un processus fils pour voir s'il s'arrête (EXIT).
+ * En codage joint chaque symbole est suivi de bits de valeur nuls.
+ */
+
+static int symboles_arretent(int joint, const int *symboles, int nb)
+{
+  struct intstream *is ;
+  struct bitstream *bs ;
+  unsigned char *octets ;
+  size_t taille ;
+  float lu[8] ;
+  int i, status ;
+
+  octets = NULL ;
+  taille = 0 ;
+  bs = open_bitstream_memory(&octets, &taille, "w") ;
+  is = open_intstream(bs, Entier, NULL) ;
+  for(i=0; i<nb; i++)
+    {
+      put_entier_intstream(is, symboles[i]) ;
+      if ( joint )		/* Signe et bits de la valeur : 0 */
+	put_bits(bs, symboles[i] % 64, 0) ;
+    }
+  put_bits(bs, 32, 0) ;
+  close_intstream(is) ;
+  close_bitstream(bs) ;
+
+  if ( fork() == 0 )
+    {
+      close(2) ;
+      bs = open_bitstream_memory_read(octets, taille) ;
+      is = open_intstream(bs, Entier, NULL) ;
+      if ( joint )
+	decompresse_joint(&is, bs, NULL, TAILLE(lu), lu) ;
+      else
+	decompresse(is, is, TAILLE(lu), lu) ;
+      exit(0) ;
+    }
+  wait(&status) ;
+  free(octets) ;
+  return WIFSIGNALED(status) && WTERMSIG(status) == SIGABRT ;
+}
+
+/*
+ * Les tranches (TRANCHES=N) sont codées par les filtres "rle"
+ * et "rleinv" (liens symboliques sur "tests") :
+ * on les lance sur un fichier de blocs et on compare.
+ */
+
+#define TRANCHES_NB_BLOCS 300
+#define TRANCHES_NBE      128
+#define TRANCHES_ARRET    (128 + SIGABRT) /* Code de "sh" après EXIT */
+
+static int tranches_lance(const char *env, const char *commande)
+{
+  char ligne[999] ;
+  int r ;
+
+  sprintf(ligne, "{ ulimit -c 0 ; export %s ; %s ; } 2>/dev/null"
+	  , env, commande) ;
+  r = system(ligne) ;
+  return WIFEXITED(r) ? WEXITSTATUS(r) : -1 ;
+}
+
+static void tranches_test()
+{
+  static const char *env[] = { "SHANNON=0 TRANCHES=3", "SHANNON=1 TRANCHES=4"
+			       , "SHANNON=2 TRANCHES=2", "JOINT=1 TRANCHES=5" } ;
+  float *blocs, *lus ;
+  unsigned char entete[16] ;
+  FILE *f ;
+  int i ;
+
+  ALLOUER(blocs, TRANCHES_NB_BLOCS * TRANCHES_NBE) ;
+  ALLOUER(lus, TRANCHES_NB_BLOCS * TRANCHES_NBE + 1) ;
+  for(i=0; i<TRANCHES_NB_BLOCS * TRANCHES_NBE; i++)
+    blocs[i] = (i*7) % 13 == 0 ? (i/TRANCHES_NBE) % 50 - 25 : 0 ;
+  f = fopen("xxx.tranches", "w") ;
+  fwrite(blocs, sizeof(*blocs), TRANCHES_NB_BLOCS * TRANCHES_NBE, f) ;
+  fclose(f) ;
+
+  for(i=0; i<TAILLE(env); i++)
+    {
+      if ( tranches_lance(env[i], "./rle <xxx.tranches >xxx.tranches.rle "
+			  "&& ./rleinv <xxx.tranches.rle >xxx.tranches.dec") )
+	{
+	  eprintf("Tranches (%s) : échec de rle ou rleinv\n", env[i]) ;
+	  return ;
+	}
+      f = fopen("xxx.tranches.dec", "r") ;
+      if ( fread(lus, sizeof(*lus), TRANCHES_NB_BLOCS * TRANCHES_NBE + 1, f)
+	   != TRANCHES_NB_BLOCS * TRANCHES_NBE
+	   || memcmp(lus, blocs, TRANCHES_NB_BLOCS * TRANCHES_NBE
+		     * sizeof(*blocs)) )
+	{
+	  eprintf("Tranches (%s) : mauvais décodage\n", env[i]) ;
+	  return ;
+	}
+      fclose(f) ;
+    }
+
+  /* Un flot tronqué ou un entête invalide arrêtent proprement */
+  if ( tranches_lance("TRANCHES=1", "head -c 100 <xxx.tranches.rle "
+		      "| ./rleinv >/dev/null") != TRANCHES_ARRET )
+    {
+      eprintf("Tranches : un flot tronqué n'est pas détecté\n") ;
+      return ;
+    }
+  if ( tranches_lance("TRANCHES=1", "printf '\\377\\377\\377\\377' "
+		      "| ./rleinv >/dev/null") != TRANCHES_ARRET )
+    {
+      eprintf("Tranches : un nombre de tranches invalide n'est pas détecté\n") ;
+      return ;
+    }
+
+  /*
+   * Une seule tranche dont l'entête annonce un segment de 4 octets :
+   * l'exception du fil de décodage est signalée après "pthread_join".
+   */
+  if ( tranches_lance("TRANCHES=1", "./rle <xxx.tranches >xxx.tranches.rle") )
+    {
+      eprintf("Tranches : échec de rle avec une tranche\n") ;
+      return ;
+    }
+  f = fopen("xxx.tranches.rle", "r") ;
+  if ( fread(entete, 1, sizeof(entete), f) != sizeof(entete) )
+    {
+      eprintf("Tranches : flot trop court\n") ;
+      return ;
+    }
+  fclose(f) ;
+  entete[8] = entete[9] = entete[10] = 0 ;
+  entete[11] = 4 ;
+  f = fopen("xxx.tranches.rle", "w") ;
+  fwrite(entete, 1, sizeof(entete), f) ;
+  fclose(f) ;
+  if ( tranches_lance("TRANCHES=1", "./rleinv <xxx.tranches.rle >/dev/null")
+       != TRANCHES_ARRET )
+    {
+      eprintf("Tranches : l'erreur d'une tranche n'est pas signalée\n") ;
+      return ;
+    }
+
+  unlink("xxx.tranches") ;
+  unlink("xxx.tranches.rle") ;
+  unlink("xxx.tranches.dec") ;
+  free(blocs) ;
+  free(lus) ;
+}
+
 void decompresse_tst()
 {
   static float ok[] = { 0, -1, 0, 0, 1, 2, 0,0,0 } ;
@@ -100,4 +347,346 @@ void decompresse_tst()
       eprintf("Un entier de trop a été lu\n") ;
       return ;
     }
+
+  /* Flot corrompu : trop de 0 pour le tableau (8 valeurs) */
+  {
+    static const int trop[] = { 9 } ;
+    static const int apres[] = { 3, 1, 5 } ;
+    if ( !symboles_arretent(0, trop, TAILLE(trop))
+	 || !symboles_arretent(0, apres, TAILLE(apres)) )
+      {
+	eprintf("Une suite de 0 qui déborde du tableau n'est pas détectée\n") ;
+	return ;
+      }
+  }
+
+  tranches_test() ;
+}
+
+/*
+ * Deux bandes, chacune dans son propre "bitstream" en mémoire
+ * pour vérifier que les entiers vont dans la bonne bande.
+ * La suite de 0 qui commence en position 3 est dans la bande 0
+ * bien que la valeur qui la termine soit dans la bande 1.
+ */
+
+static float bandes_t[] = { 0, 0, 5, 0, -2, 0, 0, 0 } ;
+static int bandes_b[] = { 0, 0, 0, 0, 1, 1, 1, 1 } ;
+
+static void bandes_ecrit(unsigned char **octets, size_t *taille)
+{
+  struct intstream *entier[2], *entier_signe[2] ;
+  struct bitstream *bs[2] ;
+  int i ;
+
+  for(i=0; i<2; i++)
+    {
+      octets[i] = NULL ;
+      taille[i] = 0 ;
+      bs[i] = open_bitstream_memory(&octets[i], &taille[i], "w") ;
+      entier[i] = open_intstream(bs[i], Entier, NULL) ;
+      entier_signe[i] = open_intstream(bs[i], Entier_Signe, NULL) ;
+    }
+  compresse_bandes(entier, entier_signe, bandes_b, TAILLE(bandes_t)
+		   , bandes_t) ;
+  for(i=0; i<2; i++)
+    {
+      put_entier_intstream(entier_signe[i], -123) ;
+      close_intstream(entier[i]) ;
+      close_intstream(entier_signe[i]) ;
+      close_bitstream(bs[i]) ;
+    }
+}
+
+void compresse_bandes_tst()
+{
+  static int ok0[] = { 2, 5, 1, -123 } ;
+  static int ok1[] = { -2, 3, -123 } ;
+  static int *ok[] = { ok0, ok1 } ;
+  static int nb[] = { TAILLE(ok0), TAILLE(ok1) } ;
+  static int signe0[] = { 0, 1, 0, 1 } ;
+  static int signe1[] = { 1, 0, 1 } ;
+  static int *signe[] = { signe0, signe1 } ;
+
+  unsigned char *octets[2] ;
+  size_t taille[2] ;
+  struct intstream *entier, *entier_signe ;
+  struct bitstream *bs ;
+  int i, j, v ;
+
+  bandes_ecrit(octets, taille) ;
+  for(i=0; i<2; i++)
+    {
+      bs = open_bitstream_memory(&octets[i], &taille[i], "r") ;
+      entier = open_intstream(bs, Entier, NULL) ;
+      entier_signe = open_intstream(bs, Entier_Signe, NULL) ;
+      for(j=0; j<nb[i]; j++)
+	{
+	  v = get_entier_intstream(signe[i][j] ? entier_signe : entier) ;
+	  if ( v != ok[i][j] )
+	    {
+	      eprintf("Bande %d, entier %d : %d au lieu de %d\n"
+		      , i, j, v, ok[i][j]) ;
+	      return ;
+	    }
+	}
+      close_intstream(entier) ;
+      close_intstream(entier_signe) ;
+      close_bitstream(bs) ;
+      free(octets[i]) ;
+    }
+}
+
+/*
+ * Aller-retour avec un modèle Shannon-Fano par bande
+ * et par type d'entier, comme le fait "rle" avec CONTEXTES=2.
+ */
+
+#define NB_BANDES 4
+#define NBE 64
+
+void decompresse_bandes_tst()
+{
+  struct intstream *entier[NB_BANDES], *entier_signe[NB_BANDES] ;
+  struct shannon_fano *sf[2*NB_BANDES] ;
+  struct bitstream *bs ;
+  unsigned char *octets ;
+  size_t taille ;
+  int bande[NBE] ;
+  float t[NBE], lu[NBE+1] ;
+  int i, j, bloc, sens ;
+
+  for(i=0; i<NBE; i++)
+    bande[i] = i * NB_BANDES / NBE ;
+
+  octets = NULL ;
+  taille = 0 ;
+  for(sens=0; sens<2; sens++)
+    {
+      bs = open_bitstream_memory(&octets, &taille, sens ? "r" : "w") ;
+      for(i=0; i<NB_BANDES; i++)
+	{
+	  sf[2*i] = open_shannon_fano() ;
+	  sf[2*i+1] = open_shannon_fano() ;
+	  entier[i] = open_intstream(bs, Shannon_fano, sf[2*i]) ;
+	  entier_signe[i] = open_intstream(bs, Shannon_fano, sf[2*i+1]) ;
+	}
+      for(bloc=0; bloc<100; bloc++)
+	{
+	  for(i=0; i<NBE; i++)
+	    t[i] = (i*bloc) % 7 < 2 + bande[i] ? 0 : (i*31+bloc) % 17 - 8 ;
+	  if ( sens == 0 )
+	    {
+	      compresse_bandes(entier, entier_signe, bande, NBE, t) ;
+	      continue ;
+	    }
+	  lu[NBE] = 1234 ;
+	  decompresse_bandes(entier, entier_signe, bande, NBE, lu) ;
+	  for(j=0; j<NBE; j++)
+	    if ( lu[j] != t[j] )
+	      {
+		eprintf("Bloc %d, entier %d : %g au lieu de %g\n"
+			, bloc, j, lu[j], t[j]) ;
+		return ;
+	      }
+	  if ( lu[NBE] != 1234 )
+	    {
+	      eprintf("Vous avez débordé du tableau\n") ;
+	      return ;
+	    }
+	}
+      for(i=0; i<NB_BANDES; i++)
+	{
+	  close_intstream(entier[i]) ;
+	  close_intstream(entier_signe[i]) ;
+	}
+      close_bitstream(bs) ;
+      for(i=0; i<2*NB_BANDES; i++)
+	close_shannon_fano(sf[i]) ;
+    }
+  free(octets) ;
+}
+
+void compresse_joint_tst()
+{
+  static float t[] = { 0, 0, 5, -3, 0, 1, 0, 0 } ;
+  /* Symbole (longueur * 64 + catégorie), nombre de bits, bits */
+  static int ok[][3] = { { 2*64+3, 3, 1 }, { 2, 2, 3 }, { 64+1, 1, 0 }
+			 , { 0, 0, 0 } } ; /* Fin de bloc */
+  struct intstream *is ;
+  struct bitstream *bs ;
+  unsigned char *octets ;
+  size_t taille ;
+  int i, v ;
+
+  octets = NULL ;
+  taille = 0 ;
+  bs = open_bitstream_memory(&octets, &taille, "w") ;
+  is = open_intstream(bs, Entier, NULL) ;
+  compresse_joint(&is, bs, NULL, TAILLE(t), t) ;
+  put_entier_intstream(is, 123) ;
+  close_intstream(is) ;
+  close_bitstream(bs) ;
+
+  bs = open_bitstream_memory(&octets, &taille, "r") ;
+  is = open_intstream(bs, Entier, NULL) ;
+  for(i=0; i<TAILLE(ok); i++)
+    {
+      v = get_entier_intstream(is) ;
+      if ( v != ok[i][0] )
+	{
+	  eprintf("Symbole %d : %d au lieu de %d\n", i, v, ok[i][0]) ;
+	  return ;
+	}
+      if ( ok[i][1] && (v = get_bits(bs, ok[i][1])) != ok[i][2] )
+	{
+	  eprintf("Symbole %d : bits %d au lieu de %d\n", i, v, ok[i][2]) ;
+	  return ;
+	}
+    }
+  if ( get_entier_intstream(is) != 123 )
+    eprintf("Un entier de trop a été stocké\n") ;
+  close_intstream(is) ;
+  close_bitstream(bs) ;
+  free(octets) ;
+}
+
+/*
+ * Aller-retour avec Shannon-Fano, avec une seule bande
+ * puis une par quart de tableau.
+ */
+
+void decompresse_joint_tst()
+{
+  static const float valeurs[] = { 1, -1, 2, -1000000, 1048575, -1048576
+				   , 7.4, -0.6 } ;
+  struct intstream *symbole[NB_BANDES] ;
+  struct shannon_fano *sf[NB_BANDES] ;
+  struct bitstream *bs ;
+  unsigned char *octets ;
+  size_t taille ;
+  int bande[NBE] ;
+  float t[NBE], lu[NBE+1] ;
+  int i, j, bloc, sens, bandes ;
+
+  for(i=0; i<NBE; i++)
+    bande[i] = i * NB_BANDES / NBE ;
+
+  for(bandes=0; bandes<2; bandes++)
+    {
+      octets = NULL ;
+      taille = 0 ;
+      for(sens=0; sens<2; sens++)
+	{
+	  bs = open_bitstream_memory(&octets, &taille, sens ? "r" : "w") ;
+	  for(i=0; i<NB_BANDES; i++)
+	    {
+	      sf[i] = open_shannon_fano() ;
+	      symbole[i] = open_intstream(bs, Shannon_fano, sf[i]) ;
+	    }
+	  for(bloc=0; bloc<100; bloc++)
+	    {
+	      for(i=0; i<NBE; i++)
+		t[i] = bloc == 1 || (i*bloc) % 5 < 3 ? 0
+		  : valeurs[(i+bloc) % TAILLE(valeurs)] ;
+	      if ( bloc == 2 )
+		for(i=0; i<NBE; i++)
+		  t[i] = -3 ;
+	      if ( sens == 0 )
+		{
+		  compresse_joint(symbole, bs, bandes ? bande : NULL, NBE, t) ;
+		  continue ;
+		}
+	      lu[NBE] = 1234 ;
+	      decompresse_joint(symbole, bs, bandes ? bande : NULL, NBE, lu) ;
+	      for(j=0; j<NBE; j++)
+		if ( lu[j] != rint(t[j]) )
+		  {
+		    eprintf("Bloc %d, entier %d : %g au lieu de %g\n"
+			    , bloc, j, lu[j], rint(t[j])) ;
+		    return ;
+		  }
+	      if ( lu[NBE] != 1234 )
+		{
+		  eprintf("Vous avez débordé du tableau\n") ;
+		  return ;
+		}
+	    }
+	  for(i=0; i<NB_BANDES; i++)
+	    {
+	      close_intstream(symbole[i]) ;
+	      close_shannon_fano(sf[i]) ;
+	    }
+	  close_bitstream(bs) ;
+	}
+      free(octets) ;
+    }
+
+  /*
+   * Flot corrompu : symbole de catégorie 0 qui n'est ni FIN_DE_BLOC
+   * ni FIN_DE_FLOT, suite de 0 sans place pour la valeur qui suit.
+   */
+  {
+    static const int categorie_nulle[] = { 2*64 } ;
+    static const int trop[] = { 8*64 + 1 } ;
+    static const int apres[] = { 3*64 + 1, 4*64 + 1 } ;
+    if ( !symboles_arretent(1, categorie_nulle, TAILLE(categorie_nulle)) )
+      {
+	eprintf("Un symbole de catégorie 0 invalide n'est pas détecté\n") ;
+	return ;
+      }
+    if ( !symboles_arretent(1, trop, TAILLE(trop))
+	 || !symboles_arretent(1, apres, TAILLE(apres)) )
+      {
+	eprintf("Une suite de 0 qui déborde du tableau n'est pas détectée\n") ;
+	return ;
+      }
+  }
+}
+
+void termine_joint_tst()
+{
+  static float t[] = { 0, 3, 0, 0 } ;
+  struct intstream *is ;
+  struct shannon_fano *sf ;
+  struct bitstream *bs ;
+  unsigned char *octets ;
+  size_t taille ;
+  float lu[TAILLE(t)] ;
+  int i ;
+  volatile int nb ;		/* Modifié avant le "longjmp" */
+
+  /* Assez de blocs pour que la fin de bloc ait un code très court */
+  octets = NULL ;
+  taille = 0 ;
+  bs = open_bitstream_memory(&octets, &taille, "w") ;
+  sf = open_shannon_fano() ;
+  is = open_intstream(bs, Shannon_fano, sf) ;
+  for(i=0; i<100; i++)
+    compresse_joint(&is, bs, NULL, TAILLE(t), t) ;
+  termine_joint(&is, NULL) ;
+  close_intstream(is) ;
+  close_shannon_fano(sf) ;
+  close_bitstream(bs) ;
+
+  bs = open_bitstream_memory(&octets, &taille, "r") ;
+  sf = open_shannon_fano() ;
+  is = open_intstream(bs, Shannon_fano, sf) ;
+  nb = 0 ;
+  EXCEPTION(for(;;)
+	    {
+	      decompresse_joint(&is, bs, NULL, TAILLE(t), lu) ;
+	      nb++ ;
+	    }
+	    ,
+	    ,
+	    case Exception_fichier_lecture:
+	    break ;
+	    ) ;
+  if ( nb != 100 )
+    eprintf("%d blocs relus au lieu de 100\n", nb) ;
+  close_intstream(is) ;
+  close_shannon_fano(sf) ;
+  close_bitstream(bs) ;
+  free(octets) ;
 }
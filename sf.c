@@ -18,24 +18,360 @@ struct evenement
   int nb_occurrences ;
  } ;
 
+/*
+ * "index" est une table de hachage (adressage ouvert, sondage linéaire)
+ * qui donne la position dans "evenements" d'une valeur :
+ * chaque case contient une position ou -1 si elle est libre.
+ * On la met à jour à chaque ajout et à chaque échange.
+ * Elle fait "1 << (32 - decalage)" cases et reste au moins à moitié vide.
+ */
+
+/*
+ * "cumul" est un arbre de Fenwick (indices à partir de 1) sur les nombres
+ * d'occurrences : la somme des occurrences de "evenements[0..i]"
+ * et sa mise à jour coûtent O(log n). Il a "taille_cumul" cases utiles
+ * (une puissance de 2) et il est reconstruit quand la table le dépasse.
+ */
+
+/*
+ * La table "evenements" commence petite (CAPACITE_INITIALE)
+ * et double quand elle est pleine.
+ * Si "nb_max" n'est pas nul, la table n'a jamais plus de "nb_max"
+ * événements : un nouvel événement est alors toujours envoyé
+ * avec ESCAPE suivi de sa valeur, sans être ajouté à la table.
+ */
+
+#define CAPACITE_INITIALE 16
+
+/*
+ * L'arbre de partition (les séparations successives) est gardé
+ * pour ne pas appeler "trouve_separation" à chaque bit.
+ * Un noeud d'intervalle [min..max] coupé après la position "s"
+ * est rangé dans "noeuds[s]" : chaque séparation n'apparaît
+ * qu'une fois dans l'arbre.
+ * Un lien (racine ou fils) vaut -1 si le noeud n'est pas encore
+ * calculé (ou si c'est une feuille, il ne sert alors pas).
+ * "somme" et "somme_gauche" sont les occurrences de [min..max]
+ * et de [min..s] : elles suffisent à vérifier la séparation
+ * après un incrément (voir "repare_arbre").
+ */
+
+struct noeud
+ {
+  int min, max ;
+  int somme, somme_gauche ;
+  int fils[2] ;
+ } ;
+
+/*
+ * Les événements de même nombre d'occurrences sont consécutifs
+ * dans la table : ils forment une série "series[serie[i]]"
+ * commençant à la position "premier" et contenant "taille" événements.
+ * Quand un événement est incrémenté, on l'échange avec le premier
+ * de sa série (comme les listes de frères de Huffman adaptatif)
+ * et il passe dans la série précédente : tout est en O(1).
+ * Les séries inutilisées sont chaînées par "premier" depuis "serie_libre".
+ */
+
+struct serie
+ {
+  int premier ;
+  int taille ;
+ } ;
+
+/*
+ * Mode semi-adaptatif (voir "open_shannon_fano_fenetre") :
+ * le code est gelé pendant "fenetre" valeurs puis reconstruit.
+ * Le code gelé porte sur les "nb_gele" premiers événements,
+ * "codes" et "longueurs" donnent le code de chaque position
+ * et "decodage" (indexé par les BITS_DECODAGE prochains bits)
+ * la position décodée et la longueur de son code
+ * (position -1 si le code est plus long que BITS_DECODAGE).
+ */
+
+#define BITS_DECODAGE 10
+
+struct decodage
+ {
+  int position ;
+  int longueur ;
+ } ;
+
 struct shannon_fano
  {
   int nb_evenements ;
-  struct evenement evenements[200000] ;
+  int capacite ;
+  int nb_max ;
+  int fenetre ;
+  int longueur_fenetre ;
+  int reste ;
+  int nb_gele ;
+  int escape_gele ;
+  unsigned long *codes ;
+  int *longueurs ;
+  struct decodage *decodage ;
+  int *serie ;
+  struct serie *series ;
+  int serie_libre ;
+  int *index ;
+  int decalage ;
+  int *cumul ;
+  int taille_cumul ;
+  int racine ;
+  struct noeud *noeuds ;
+  struct evenement *evenements ;
  } ;
 
+static void repare_arbre(struct shannon_fano *sf, int j, Booleen ajout) ;
+
+/*
+ * L'événement de la position "i" vient d'arriver à la fin de sa série
+ * (ou est nouveau) : il rejoint la série de la position "i-1"
+ * si elle a le même nombre d'occurrences, sinon il en commence une.
+ */
+
+static void range_dans_serie(struct shannon_fano *sf, int i)
+{
+  int s ;
+
+  if ( i > 0 && sf->evenements[i-1].nb_occurrences
+       == sf->evenements[i].nb_occurrences )
+    s = sf->serie[i-1] ;
+  else
+    {
+      s = sf->serie_libre ;
+      sf->serie_libre = sf->series[s].premier ;
+      sf->series[s].premier = i ;
+      sf->series[s].taille = 0 ;
+    }
+  sf->series[s].taille++ ;
+  sf->serie[i] = s ;
+}
+
+/*
+ * Enlève le premier événement de la série "s".
+ */
+
+static void enleve_premier_de_serie(struct shannon_fano *sf, int s)
+{
+  sf->series[s].premier++ ;
+  if ( --sf->series[s].taille == 0 )
+    {
+      sf->series[s].premier = sf->serie_libre ;
+      sf->serie_libre = s ;
+    }
+}
+
+/*
+ * Chaîne les séries libres de "debut" à "fin" (exclue).
+ */
+
+static void libere_series(struct shannon_fano *sf, int debut, int fin)
+{
+  for( ; debut < fin ; debut++)
+    {
+      sf->series[debut].premier = sf->serie_libre ;
+      sf->serie_libre = debut ;
+    }
+}
+
+#define TAILLE_INDEX(SF) (1u << (32 - (SF)->decalage))
+
+/*
+ * Ajoute "delta" aux occurrences cumulées à partir de la position "i".
+ */
+
+static void ajoute_cumul(struct shannon_fano *sf, int i, int delta)
+{
+  for(i++; i <= sf->taille_cumul; i += i & -i)
+    sf->cumul[i] += delta ;
+}
+
+/*
+ * Somme des occurrences de "evenements[0..i]" (0 si i vaut -1).
+ */
+
+static int somme_cumul(const struct shannon_fano *sf, int i)
+{
+  int somme = 0 ;
+
+  for(i++; i > 0; i -= i & -i)
+    somme += sf->cumul[i] ;
+  return somme ;
+}
+
+/*
+ * Alloue l'arbre de Fenwick et le remplit en O(n).
+ */
+
+static void construit_cumul(struct shannon_fano *sf, int taille)
+{
+  int i, j ;
+
+  sf->taille_cumul = taille ;
+  ALLOUER(sf->cumul, taille + 1) ;
+  memset(sf->cumul, 0, (taille + 1) * sizeof(*sf->cumul)) ;
+  for(i=1; i<=taille; i++)
+    {
+      if ( i <= sf->nb_evenements )
+	sf->cumul[i] += sf->evenements[i-1].nb_occurrences ;
+      j = i + (i & -i) ;
+      if ( j <= taille )
+	sf->cumul[j] += sf->cumul[i] ;
+    }
+}
+
+/*
+ * Retourne la case de l'index contenant la position de "valeur",
+ * ou la case libre où la mettre si elle n'est pas dans la table.
+ * Le hachage multiplicatif (Knuth) prend les bits de poids fort.
+ */
+
+static int *case_index(const struct shannon_fano *sf, int valeur)
+{
+  unsigned int h = ((unsigned int)valeur * 2654435761u) >> sf->decalage ;
+
+  while ( sf->index[h] >= 0
+	  && sf->evenements[sf->index[h]].valeur != valeur )
+    h = (h + 1) & (TAILLE_INDEX(sf) - 1) ;
+  return &sf->index[h] ;
+}
+
+/*
+ * Alloue l'index et y range les événements de la table.
+ */
+
+static void construit_index(struct shannon_fano *sf, int decalage)
+{
+  int i, *c ;
+
+  sf->decalage = decalage ;
+  ALLOUER(sf->index, TAILLE_INDEX(sf)) ;
+  memset(sf->index, -1, TAILLE_INDEX(sf) * sizeof(*sf->index)) ;
+  for(i=0; i<sf->nb_evenements; i++)
+    {
+      c = case_index(sf, sf->evenements[i].valeur) ;
+      if ( *c < 0 )
+	*c = i ;
+    }
+}
+
+/*
+ * Ajoute un événement (avec une occurrence) à la fin de la table.
+ * Si sa valeur est déjà dans la table (ce n'est possible que pour
+ * la valeur de ESCAPE) l'index n'est pas modifié.
+ * Si la table a atteint sa limite, on ne fait rien.
+ */
+
+static void ajoute_evenement(struct shannon_fano *sf, int valeur)
+{
+  int *c ;
+  struct evenement e = { valeur, 1 } ;
+
+  if ( sf->nb_evenements == sf->nb_max )
+    return ;
+  if ( sf->nb_evenements == sf->capacite )
+    {
+      sf->capacite *= 2 ;
+      sf->evenements = realloc(sf->evenements
+			       , sf->capacite * sizeof(*sf->evenements)) ;
+      sf->noeuds = realloc(sf->noeuds, sf->capacite * sizeof(*sf->noeuds)) ;
+      sf->serie = realloc(sf->serie, sf->capacite * sizeof(*sf->serie)) ;
+      sf->series = realloc(sf->series, sf->capacite * sizeof(*sf->series)) ;
+      sf->codes = realloc(sf->codes, sf->capacite * sizeof(*sf->codes)) ;
+      sf->longueurs = realloc(sf->longueurs
+			      , sf->capacite * sizeof(*sf->longueurs)) ;
+      if ( sf->evenements == NULL || sf->noeuds == NULL
+	   || sf->serie == NULL || sf->series == NULL
+	   || sf->codes == NULL || sf->longueurs == NULL )
+	{
+	  fprintf(stderr, "Plus de memoire\n") ;
+	  EXIT ;
+	}
+      libere_series(sf, sf->capacite / 2, sf->capacite) ;
+    }
+  sf->evenements[sf->nb_evenements++] = e ;
+  if ( !sf->fenetre )
+    range_dans_serie(sf, sf->nb_evenements - 1) ;
+  if ( sf->nb_evenements > sf->taille_cumul )
+    {
+      free(sf->cumul) ;
+      construit_cumul(sf, 2 * sf->taille_cumul) ;
+    }
+  else
+    ajoute_cumul(sf, sf->nb_evenements - 1, 1) ;
+  if ( 2u * sf->nb_evenements > TAILLE_INDEX(sf) )
+    {
+      free(sf->index) ;
+      construit_index(sf, sf->decalage - 1) ;
+    }
+  else
+    {
+      c = case_index(sf, valeur) ;
+      if ( *c < 0 )
+	*c = sf->nb_evenements - 1 ;
+    }
+  if ( !sf->fenetre )
+    repare_arbre(sf, sf->nb_evenements - 1, Vrai) ;
+}
+
+/*
+ * Echange deux événements de la table en mettant à jour l'index.
+ */
+
+static void echange(struct shannon_fano *sf, int i, int j)
+{
+  struct evenement tmp = sf->evenements[i] ;
+  int *ci = case_index(sf, sf->evenements[i].valeur) ;
+  int *cj = case_index(sf, sf->evenements[j].valeur) ;
+
+  //Les cases sont cherchées avant l'échange (elles désignent i et j)
+  sf->evenements[i] = sf->evenements[j] ;
+  sf->evenements[j] = tmp ;
+  if ( *ci == i )
+    *ci = j ;
+  if ( *cj == j )
+    *cj = i ;
+}
+
 /*
  * Allocation des la structure et remplissage des champs pour initialiser
  * le tableau des événements avec l'événement ESCAPE (avec une occurrence).
  */
 struct shannon_fano* open_shannon_fano()
+{
+  return open_shannon_fano_limite(0);
+}
+
+/*
+ * Comme "open_shannon_fano" mais la table ne dépassera pas
+ * "nb_max" événements (ESCAPE compris), 0 pour ne pas limiter.
+ * Le décodeur doit être ouvert avec la même limite.
+ */
+struct shannon_fano* open_shannon_fano_limite(int nb_max)
 {
   struct shannon_fano *sf;
   ALLOUER(sf, 1);
 
   struct evenement e = { VALEUR_ESCAPE, 1};
+  sf->capacite = CAPACITE_INITIALE;
+  sf->nb_max = nb_max > 0 ? nb_max : -1;
+  ALLOUER(sf->evenements, sf->capacite);
+  ALLOUER(sf->noeuds, sf->capacite);
+  ALLOUER(sf->serie, sf->capacite);
+  ALLOUER(sf->series, sf->capacite);
+  ALLOUER(sf->codes, sf->capacite);
+  ALLOUER(sf->longueurs, sf->capacite);
+  sf->fenetre = 0;
+  sf->decodage = NULL;
+  sf->serie_libre = -1;
+  libere_series(sf, 0, sf->capacite);
+  sf->racine = -1;
   sf->nb_evenements = 1;
   sf->evenements[0] = e;
+  range_dans_serie(sf, 0);
+  construit_index(sf, 32 - 5);
+  construit_cumul(sf, CAPACITE_INITIALE);
   return sf;
 }
 
@@ -44,6 +380,15 @@ struct shannon_fano* open_shannon_fano()
  */
 void close_shannon_fano(struct shannon_fano *sf)
 {
+  free(sf->index);
+  free(sf->cumul);
+  free(sf->evenements);
+  free(sf->noeuds);
+  free(sf->serie);
+  free(sf->series);
+  free(sf->codes);
+  free(sf->longueurs);
+  free(sf->decodage);
   free(sf);
 }
 
@@ -56,11 +401,11 @@ void close_shannon_fano(struct shannon_fano *sf)
 
 static int trouve_position(const struct shannon_fano *sf, int evenement)
 {
-  for (int i=0; i<sf->nb_evenements; ++i) {
-    if (sf->evenements[i].valeur == evenement)
-      return i;
-  }
-  return trouve_position(sf, VALEUR_ESCAPE);
+  int position = *case_index(sf, evenement);
+
+  if (position < 0)
+    return *case_index(sf, VALEUR_ESCAPE);
+  return position;
 }
 
 /*
@@ -77,67 +422,152 @@ static int trouve_position(const struct shannon_fano *sf, int evenement)
  * de la somme des occurrences supérieures et inférieures.
  *
  * L'algorithme (trivial) n'est pas facile à trouver, réfléchissez bien.
+ *
+ * L'algorithme trivial (deux sommes qui avancent l'une vers l'autre,
+ * la plus petite avance) coûte O(n). On trouve le même résultat
+ * avec les sommes cumulées : en notant L(i) la somme des occurrences
+ * de "position_min" à "i", la séparation est le plus grand "i"
+ * de "position_min" à "position_max-1" tel que :
+ *                   i == position_min
+ *             ou    L(i-1) + L(i) <= L(position_max)
+ * Comme toutes les occurrences sont positives, L(i-1) + L(i) croît
+ * strictement : on descend l'arbre de Fenwick depuis sa racine,
+ * chaque pas ajoute une case de "cumul" à la somme, donc en O(log n).
  */
 static int trouve_separation(const struct shannon_fano *sf
 			     , int position_min
 			     , int position_max)
 {
-  // int nbEvent = position_max - position_min + 1;
-  // int accumulateSum[nbEvent];
-  // int sum = 0;
-
-  // int i;
-  // for (i=0; i<nbEvent; ++i) {
-  //   sum += sf->evenements[position_min + i].nb_occurrences;
-  //   accumulateSum[i] = sum;
-  // }
-   
-  // int middle = accumulateSum[nbEvent-1] / 2;
-    
-  // for (i=0; i<nbEvent; ++i) {
-  //   if (accumulateSum[i] >= middle)
-  //     return position_min+i;
-  // }
-
-  //OU
-  int sum_min = sf->evenements[position_min].nb_occurrences;    
-  int sum_max = sf->evenements[position_max].nb_occurrences;
-  while(position_min != position_max - 1) {
-    if (sum_max < sum_min) {
-      position_max -= 1;
-      sum_max += sf->evenements[position_max].nb_occurrences;
+  int nb = 0, pas, somme = 0;
+  //Les sommes sont globales : on ajoute la somme avant "position_min"
+  int total = somme_cumul(sf, position_max) + somme_cumul(sf, position_min - 1);
+
+  //"somme" est celle des "nb" premières positions, "nb-1" est acceptée
+  for (pas = sf->taille_cumul; pas > 0; pas >>= 1)
+    if (nb + pas <= position_max
+	&& 2 * (somme + sf->cumul[nb + pas])
+	   - sf->evenements[nb + pas - 1].nb_occurrences <= total) {
+      nb += pas;
+      somme += sf->cumul[nb];
+    }
+  return nb - 1 < position_min ? position_min : nb - 1;
+}
+
+/*
+ * Calcule le noeud de l'intervalle [min..max] (au moins 2 positions)
+ * et retourne sa séparation (c'est aussi son indice).
+ * Ses fils seront calculés quand on en aura besoin.
+ */
+
+static int cree_noeud(struct shannon_fano *sf, int min, int max)
+{
+  int s = trouve_separation(sf, min, max);
+  struct noeud *nd = &sf->noeuds[s];
+  int avant = somme_cumul(sf, min - 1);
+
+  nd->min = min;
+  nd->max = max;
+  nd->somme = somme_cumul(sf, max) - avant;
+  nd->somme_gauche = somme_cumul(sf, s) - avant;
+  nd->fils[0] = nd->fils[1] = -1;
+  return s;
+}
+
+/*
+ * Retourne la séparation du noeud après une modification de ses sommes,
+ * en partant de l'ancienne séparation "s" (voir "trouve_separation"
+ * pour la condition). Avec L(s) = somme_gauche :
+ *     L(s-1) + L(s)   = 2 L(s) - occ(s)
+ *     L(s)   + L(s+1) = 2 L(s) + occ(s+1)
+ * Le plus souvent la séparation ne bouge pas ou d'une position.
+ */
+
+static int deplace_separation(const struct shannon_fano *sf
+			      , struct noeud *nd, int s)
+{
+  int l = nd->somme_gauche;
+
+  while (s + 1 < nd->max
+	 && 2 * l + sf->evenements[s+1].nb_occurrences <= nd->somme)
+    l += sf->evenements[++s].nb_occurrences;
+  while (s > nd->min
+	 && 2 * l - sf->evenements[s].nb_occurrences > nd->somme)
+    l -= sf->evenements[s--].nb_occurrences;
+  nd->somme_gauche = l;
+  return s;
+}
+
+/*
+ * L'occurrence de la position "j" vient d'augmenter de 1
+ * ("ajout" est Vrai si "j" est le nouvel événement en fin de table).
+ * Seuls les noeuds dont l'intervalle contient "j" sont touchés :
+ * on descend le chemin de "j" en mettant à jour les sommes.
+ * Si une séparation change, le noeud change d'indice et tout
+ * son sous-arbre sera recalculé à la demande.
+ */
+
+static void repare_arbre(struct shannon_fano *sf, int j, Booleen ajout)
+{
+  int *lien = &sf->racine, s, t;
+  struct noeud *nd;
+
+  while (*lien >= 0) {
+    s = *lien;
+    nd = &sf->noeuds[s];
+    if (ajout)
+      nd->max++;
+    nd->somme++;
+    if (j <= s)
+      nd->somme_gauche++;
+    t = deplace_separation(sf, nd, s);
+    if (t != s) {
+      sf->noeuds[t] = *nd;
+      sf->noeuds[t].fils[0] = sf->noeuds[t].fils[1] = -1;
+      *lien = t;
+      return;
+    }
+    if (j <= s) {
+      if (nd->min == s) //Feuille
+	return;
+      lien = &nd->fils[0];
     }
     else {
-      position_min += 1;
-      sum_min += sf->evenements[position_min].nb_occurrences;
+      if (s + 1 == nd->max) //Feuille
+	return;
+      lien = &nd->fils[1];
     }
   }
-  return position_min;
-
 }
 
 /*
  * Cette fonction (simplement itérative)
- * utilise "trouve_separation" pour générer les bons bit dans "bs"
+ * descend l'arbre de partition (les séparations de "trouve_separation")
+ * pour générer les bons bit dans "bs"
  * le code de l'événement "sf->evenements[position]".
+ * Le code porte sur les "nb" premières positions de la table.
  */
 
 static void encode_position(struct bitstream *bs,struct shannon_fano *sf,
-		     int position)
+		     int position, int nb)
 {
-
   int position_min = 0;
-  int position_max = sf->nb_evenements-1;
+  int position_max = nb-1;
+  int *lien = &sf->racine;
   int sep;
+
   while (position_min != position_max) {
-    sep = trouve_separation(sf, position_min, position_max);
+    if (*lien < 0)
+      *lien = cree_noeud(sf, position_min, position_max);
+    sep = *lien;
     if (position > sep) {
       position_min = sep+1;
       put_bit(bs, 1);
+      lien = &sf->noeuds[sep].fils[1];
     }
     else {
       position_max = sep;
       put_bit(bs, 0);
+      lien = &sf->noeuds[sep].fils[0];
     }
   }
 }
@@ -149,26 +579,36 @@ static void encode_position(struct bitstream *bs,struct shannon_fano *sf,
  * d'occurrence (un simple échange d'événement suffit)
  *
  * Les faibles indices correspondent aux grand nombres d'occurrences
+ *
+ * On échange avec le premier événement de la série (voir "struct serie"),
+ * c'est le premier qui a maintenant moins d'occurrences.
  */
 
 static void incremente_et_ordonne(struct shannon_fano *sf, int position)
 {
+  int s = sf->serie[position];
+  int i = sf->series[s].premier;
+
   sf->evenements[position].nb_occurrences++;
-  if (position == 0) 
-    return;
+  if (i != position)
+    echange(sf, i, position);
+  enleve_premier_de_serie(sf, s);
+  range_dans_serie(sf, i);
 
-  for (int i=0; i<position; ++i) {
-    //Le premier event qu'on trouve avec un nb occurence inférieur ou égal au nbOcc
-    //Est échangé avec l'event actuel
-    if (sf->evenements[i].nb_occurrences < sf->evenements[position].nb_occurrences) {
-      struct evenement tmp = sf->evenements[position];
-      sf->evenements[position] = sf->evenements[i];
-      sf->evenements[i] = tmp; 
-      return;
-    }
-  }
+  //Au final seule l'occurrence de la position "i" a augmenté
+  ajoute_cumul(sf, i, 1);
+  repare_arbre(sf, i, Faux);
 }
 
+/*
+ * Mode semi-adaptatif, voir plus bas
+ */
+static void put_entier_shannon_fano_fenetre(struct bitstream *bs
+					    , struct shannon_fano *sf
+					    , int evenement) ;
+static int get_entier_shannon_fano_fenetre(struct bitstream *bs
+					   , struct shannon_fano *sf) ;
+
 /*
  * Cette fonction trouve la position de l'événement puis l'encode.
  * Si la position envoyée est celle de ESCAPE, elle fait un "put_bits"
@@ -178,8 +618,12 @@ static void incremente_et_ordonne(struct shannon_fano *sf, int position)
 void put_entier_shannon_fano(struct bitstream *bs
 			     ,struct shannon_fano *sf, int evenement)
 { 
+  if (sf->fenetre) {
+    put_entier_shannon_fano_fenetre(bs, sf, evenement);
+    return;
+  }
   int position = trouve_position(sf, evenement);
-  encode_position(bs, sf, position);
+  encode_position(bs, sf, position, sf->nb_evenements);
 
   if (sf->evenements[position].valeur == VALEUR_ESCAPE) {
     //position ESCAPE, event pas encore dans la table
@@ -187,8 +631,7 @@ void put_entier_shannon_fano(struct bitstream *bs
     put_bits(bs, sizeof(int) * 8, evenement);
 
     //On ajoute l'event à sf
-    struct evenement s_evenement = { evenement, 1 };
-    sf->evenements[sf->nb_evenements++] = s_evenement;
+    ajoute_evenement(sf, evenement);
 
   }
   //On incrémente après car l'event peut changer de position
@@ -200,21 +643,26 @@ void put_entier_shannon_fano(struct bitstream *bs
 /*
  * Fonction inverse de "encode_position"
  */
-static int decode_position(struct bitstream *bs,struct shannon_fano *sf)
+static int decode_position(struct bitstream *bs,struct shannon_fano *sf, int nb)
 {
   int position_min = 0;
-  int position_max = sf->nb_evenements-1;
+  int position_max = nb-1;
+  int *lien = &sf->racine;
   int sep;
   while(position_min != position_max) {
-    sep = trouve_separation(sf, position_min, position_max);
+    if (*lien < 0)
+      *lien = cree_noeud(sf, position_min, position_max);
+    sep = *lien;
   
     if (get_bit(bs)) {
       //position > sep
       position_min = sep+1;
+      lien = &sf->noeuds[sep].fils[1];
     }
     else {
       //position <= sep
       position_max = sep;
+      lien = &sf->noeuds[sep].fils[0];
     }
   }
 
@@ -230,7 +678,9 @@ static int decode_position(struct bitstream *bs,struct shannon_fano *sf)
  */
 int get_entier_shannon_fano(struct bitstream *bs, struct shannon_fano *sf)
 {
-  int position = decode_position(bs, sf);
+  if (sf->fenetre)
+    return get_entier_shannon_fano_fenetre(bs, sf);
+  int position = decode_position(bs, sf, sf->nb_evenements);
   //On se souvient de l'évenement car il peut changer de position
   int evenement = sf->evenements[position].valeur;
   incremente_et_ordonne(sf, position);
@@ -240,13 +690,290 @@ int get_entier_shannon_fano(struct bitstream *bs, struct shannon_fano *sf)
     evenement = get_bits(bs, sizeof(int) * 8);
 
     //On doit l'ajouter à la table
-    struct evenement e = {evenement, 1};
-    sf->evenements[sf->nb_evenements++] = e;
+    ajoute_evenement(sf, evenement);
+  }
+
+  return evenement;
+}
+
+/*
+ * Mode semi-adaptatif.
+ *
+ * Le code ne change pas à chaque valeur, il est gelé pendant
+ * "taille_fenetre" valeurs pendant lesquelles on compte seulement
+ * les occurrences (et on ajoute les nouveaux événements en fin de table).
+ * A la fin de la fenêtre, la table est triée puis on recalcule
+ * tous les codes et une table de décodage : à l'intérieur
+ * d'une fenêtre, coder ou décoder est une simple lecture de table.
+ * Un événement qui n'est pas dans le code gelé est toujours
+ * envoyé par ESCAPE suivi de sa valeur.
+ *
+ * Au départ le code ne contient que ESCAPE : pour ne pas envoyer
+ * toute une fenêtre de valeurs par ESCAPE, la première fenêtre
+ * fait FENETRE_DEBUT valeurs et chaque fenêtre double
+ * jusqu'à "taille_fenetre".
+ *
+ * On utilise ce modèle avec les mêmes fonctions
+ * "put_entier_shannon_fano" et "get_entier_shannon_fano".
+ */
+#define FENETRE_DEBUT 64
+
+struct shannon_fano* open_shannon_fano_fenetre(int taille_fenetre)
+{
+  struct shannon_fano *sf = open_shannon_fano();
+
+  if (taille_fenetre <= 0)
+    EXIT;
+  sf->fenetre = taille_fenetre;
+  sf->longueur_fenetre = taille_fenetre < FENETRE_DEBUT ? taille_fenetre
+    : FENETRE_DEBUT;
+  sf->reste = 0;
+  ALLOUER(sf->decodage, 1 << BITS_DECODAGE);
+  return sf;
+}
+
+/*
+ * Ordre de la table : les fortes occurrences d'abord,
+ * puis les petites valeurs (l'ordre doit être le même au décodage).
+ */
+static int compare_evenements(const void *a, const void *b)
+{
+  const struct evenement *ea = a, *eb = b;
+
+  if (ea->nb_occurrences != eb->nb_occurrences)
+    return ea->nb_occurrences > eb->nb_occurrences ? -1 : 1;
+  return ea->valeur < eb->valeur ? -1 : ea->valeur > eb->valeur;
+}
+
+/*
+ * Trie la table puis reconstruit l'index et les sommes cumulées.
+ */
+static void trie_table(struct shannon_fano *sf)
+{
+  qsort(sf->evenements, sf->nb_evenements, sizeof(*sf->evenements)
+	, compare_evenements);
+  free(sf->index);
+  construit_index(sf, sf->decalage);
+  free(sf->cumul);
+  construit_cumul(sf, sf->taille_cumul);
+}
+
+/*
+ * Début d'une fenêtre : on trie la table puis on construit
+ * tout l'arbre de partition en donnant leur code aux positions.
+ * Les intervalles restant à couper sont dans "pile"
+ * (il y en a au plus "nb_gele") avec le lien à mettre à jour
+ * pour que "encode_position" et "decode_position" suivent l'arbre
+ * sans rien recalculer.
+ */
+static void reconstruit_code(struct shannon_fano *sf)
+{
+  int i, j, s;
+  struct {
+    int min, max, longueur, *lien;
+    unsigned long code;
+  } *pile, t;
+  int haut;
+
+  trie_table(sf);
+  sf->nb_gele = sf->nb_evenements;
+  sf->escape_gele = *case_index(sf, VALEUR_ESCAPE);
+  sf->reste = sf->longueur_fenetre;
+  sf->longueur_fenetre = sf->longueur_fenetre > sf->fenetre / 2 ? sf->fenetre
+    : 2 * sf->longueur_fenetre;
+
+  //Les codes
+  ALLOUER(pile, sf->nb_gele);
+  t.min = 0;
+  t.max = sf->nb_gele - 1;
+  t.longueur = 0;
+  t.code = 0;
+  t.lien = &sf->racine;
+  pile[0] = t;
+  haut = 1;
+  while (haut) {
+    t = pile[--haut];
+    if (t.min == t.max) {
+      sf->codes[t.min] = t.code;
+      sf->longueurs[t.min] = t.longueur;
+      continue;
+    }
+    s = *t.lien = cree_noeud(sf, t.min, t.max);
+    t.longueur++;
+    t.code <<= 1;
+    pile[haut] = t;
+    pile[haut].max = s;
+    pile[haut].lien = &sf->noeuds[s].fils[0];
+    haut++;
+    pile[haut] = t;
+    pile[haut].min = s + 1;
+    pile[haut].code |= 1;
+    pile[haut].lien = &sf->noeuds[s].fils[1];
+    haut++;
+  }
+  free(pile);
+
+  //La table de décodage
+  for (j = 0; j < 1 << BITS_DECODAGE; j++)
+    sf->decodage[j].position = -1;
+  for (i = 0; i < sf->nb_gele; i++)
+    if (sf->longueurs[i] <= BITS_DECODAGE) {
+      s = sf->codes[i] << (BITS_DECODAGE - sf->longueurs[i]);
+      for (j = 0; j < 1 << (BITS_DECODAGE - sf->longueurs[i]); j++) {
+	sf->decodage[s + j].position = i;
+	sf->decodage[s + j].longueur = sf->longueurs[i];
+      }
+    }
+}
+
+/*
+ * Compte une occurrence de "evenement" (à la position "position"
+ * ou -1 s'il n'est pas dans la table) sans changer le code.
+ */
+static void compte_fenetre(struct shannon_fano *sf, int position
+			   , int evenement)
+{
+  if (position < 0)
+    ajoute_evenement(sf, evenement);
+  else
+    sf->evenements[position].nb_occurrences++;
+}
+
+static void put_entier_shannon_fano_fenetre(struct bitstream *bs
+					    , struct shannon_fano *sf
+					    , int evenement)
+{
+  int position, p;
+
+  if (sf->reste == 0)
+    reconstruit_code(sf);
+  sf->reste--;
+
+  position = *case_index(sf, evenement);
+  p = position >= 0 && position < sf->nb_gele ? position : sf->escape_gele;
+  if (sf->longueurs[p] <= 8 * sizeof(*sf->codes))
+    put_bits(bs, sf->longueurs[p], sf->codes[p]);
+  else
+    encode_position(bs, sf, p, sf->nb_gele);
+
+  if (p == sf->escape_gele) {
+    put_bits(bs, sizeof(int) * 8, evenement);
+    sf->evenements[p].nb_occurrences++;
+    if (position == p)
+      return; //C'est la valeur de ESCAPE
+  }
+  compte_fenetre(sf, position, evenement);
+}
+
+static int get_entier_shannon_fano_fenetre(struct bitstream *bs
+					   , struct shannon_fano *sf)
+{
+  int p, evenement;
+  const struct decodage *d;
+
+  if (sf->reste == 0)
+    reconstruit_code(sf);
+  sf->reste--;
+
+  d = &sf->decodage[peek_bits(bs, BITS_DECODAGE)];
+  if (d->position >= 0) {
+    skip_bits(bs, d->longueur);
+    p = d->position;
   }
+  else
+    p = decode_position(bs, sf, sf->nb_gele);
 
+  if (p != sf->escape_gele) {
+    sf->evenements[p].nb_occurrences++;
+    return sf->evenements[p].valeur;
+  }
+  evenement = get_bits(bs, sizeof(int) * 8);
+  sf->evenements[p].nb_occurrences++;
+  if (evenement != VALEUR_ESCAPE)
+    compte_fenetre(sf, *case_index(sf, evenement), evenement);
   return evenement;
 }
 
+/*
+ * Modèle pré-entraîné.
+ *
+ * "sauve_shannon_fano" écrit la table des événements (ESCAPE compris)
+ * avec leur nombre d'occurrences. Les occurrences sont divisées par 2
+ * jusqu'à ce que leur somme ne dépasse pas LIMITE_MODELE
+ * (sans descendre sous 1) pour que le modèle chargé puisse
+ * encore s'adapter aux nouvelles données.
+ * Avec plus de LIMITE_MODELE événements la somme ne descend jamais
+ * jusqu'à la limite : on s'arrête quand toutes les occurrences valent 1.
+ *
+ * "open_shannon_fano_modele" crée un modèle (adaptatif si
+ * "taille_fenetre" est nul, sinon comme "open_shannon_fano_fenetre")
+ * qui commence avec la table lue : le codeur et le décodeur
+ * doivent charger la même.
+ */
+
+#define LIMITE_MODELE (1 << 16)
+
+static int occurrences_reduites(const struct evenement *e, int decalage)
+{
+  return e->nb_occurrences >> decalage ? e->nb_occurrences >> decalage : 1;
+}
+
+void sauve_shannon_fano(struct bitstream *bs, struct shannon_fano *sf)
+{
+  int i, decalage;
+  long somme;
+
+  for (decalage = 0; ; decalage++) {
+    somme = 0;
+    for (i = 0; i < sf->nb_evenements; i++)
+      somme += occurrences_reduites(&sf->evenements[i], decalage);
+    if (somme <= LIMITE_MODELE || somme == sf->nb_evenements)
+      break;
+  }
+
+  put_bits(bs, sizeof(int) * 8, sf->nb_evenements);
+  for (i = 0; i < sf->nb_evenements; i++) {
+    put_bits(bs, sizeof(int) * 8, sf->evenements[i].valeur);
+    put_bits(bs, sizeof(int) * 8
+	     , occurrences_reduites(&sf->evenements[i], decalage));
+  }
+}
+
+struct shannon_fano* open_shannon_fano_modele(struct bitstream *bs
+					      , int taille_fenetre)
+{
+  struct shannon_fano *sf;
+  int i, nb, valeur, nb_occ, position, escape;
+
+  sf = taille_fenetre ? open_shannon_fano_fenetre(taille_fenetre)
+    : open_shannon_fano();
+  nb = get_bits(bs, sizeof(int) * 8);
+  escape = 0;
+  for (i = 0; i < nb; i++) {
+    valeur = get_bits(bs, sizeof(int) * 8);
+    nb_occ = get_bits(bs, sizeof(int) * 8);
+    if (nb_occ <= 0)
+      EXIT;
+    position = *case_index(sf, valeur);
+    if (position < 0) {
+      ajoute_evenement(sf, valeur);
+      position = sf->nb_evenements - 1;
+    }
+    else if (valeur != VALEUR_ESCAPE || escape++)
+      EXIT; //Deux fois la même valeur : ce n'est pas un modèle
+    sf->evenements[position].nb_occurrences = nb_occ;
+  }
+
+  //Remet la table dans l'état d'un modèle adaptatif
+  trie_table(sf);
+  sf->serie_libre = -1;
+  libere_series(sf, 0, sf->capacite);
+  for (i = 0; i < sf->nb_evenements; i++)
+    range_dans_serie(sf, i);
+  sf->racine = -1;
+  return sf;
+}
+
 /*
  * Fonctions pour les tests, NE PAS MODIFIER, NE PAS UTILISER.
  */
@@ -259,6 +986,53 @@ void sf_get_evenement(struct shannon_fano *sf, int i, int *valeur, int *nb_occ)
    *valeur = sf->evenements[i].valeur ;
    *nb_occ = sf->evenements[i].nb_occurrences ;
  }
+int sf_trouve_separation(const struct shannon_fano *sf, int min, int max)
+ {
+   return trouve_separation(sf, min, max) ;
+ }
+static int noeud_ok(const struct shannon_fano *sf, int lien, int min, int max)
+ {
+   const struct noeud *nd ;
+
+   if ( min == max || lien < 0 )
+     return 1 ;
+   nd = &sf->noeuds[lien] ;
+   if ( nd->min != min || nd->max != max
+	|| lien != trouve_separation(sf, min, max)
+	|| nd->somme != somme_cumul(sf, max) - somme_cumul(sf, min - 1)
+	|| nd->somme_gauche != somme_cumul(sf, lien) - somme_cumul(sf, min - 1) )
+     {
+       fprintf(stderr, "Le noeud [%d..%d] de l'arbre est faux\n", min, max) ;
+       return 0 ;
+     }
+   return noeud_ok(sf, nd->fils[0], min, lien)
+     && noeud_ok(sf, nd->fils[1], lien + 1, max) ;
+ }
+int sf_arbre_ok(const struct shannon_fano *sf)
+ {
+   return noeud_ok(sf, sf->racine, 0, sf->nb_evenements - 1) ;
+ }
+int sf_series_ok(const struct shannon_fano *sf)
+ {
+   int i, s ;
+
+   for(i=0; i<sf->nb_evenements; i++)
+     {
+       s = sf->serie[i] ;
+       if ( i < sf->series[s].premier
+	    || i >= sf->series[s].premier + sf->series[s].taille
+	    || sf->evenements[i].nb_occurrences
+	    != sf->evenements[sf->series[s].premier].nb_occurrences
+	    || (i == sf->series[s].premier && i != 0
+		&& sf->evenements[i-1].nb_occurrences
+		== sf->evenements[i].nb_occurrences) )
+	 {
+	   fprintf(stderr, "La série de l'événement %d est fausse\n", i) ;
+	   return 0 ;
+	 }
+     }
+   return 1 ;
+ }
 int sf_table_ok(const struct shannon_fano *sf)
  {
   int i, escape ;
@@ -10,15 +10,22 @@
 struct shannon_fano ;
 
 struct shannon_fano* open_shannon_fano() ;
+struct shannon_fano* open_shannon_fano_limite(int nb_max) ;
+struct shannon_fano* open_shannon_fano_fenetre(int taille_fenetre) ;
+struct shannon_fano* open_shannon_fano_modele(struct bitstream *bs, int taille_fenetre) ;
 
 void close_shannon_fano(struct shannon_fano *sf) ;
 void put_entier_shannon_fano(struct bitstream *bs, struct shannon_fano *sf, int evenement) ;
 int get_entier_shannon_fano(struct bitstream *bs, struct shannon_fano *sf) ;
+void sauve_shannon_fano(struct bitstream *bs, struct shannon_fano *sf) ;
 
 /* Pour les tests */
 
 int sf_get_nb_evenements(struct shannon_fano *sf) ; /**/
 void sf_get_evenement(struct shannon_fano *sf, int i, int *valeur, int *nb_occ) ; /**/
 int sf_table_ok(const struct shannon_fano *sf) ; /**/
+int sf_trouve_separation(const struct shannon_fano *sf, int min, int max) ; /**/
+int sf_arbre_ok(const struct shannon_fano *sf) ; /**/
+int sf_series_ok(const struct shannon_fano *sf) ; /**/
 
 #endif
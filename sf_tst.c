@@ -35,6 +35,232 @@ void open_shannon_fano_tst()
     }
 }
 
+void open_shannon_fano_limite_tst()
+{
+  struct shannon_fano *sf ;
+  struct bitstream *bs ;
+  unsigned char *octets ;
+  size_t taille ;
+  int i, j ;
+
+  /*
+   * 1000 valeurs différentes (chacune 3 fois) avec une table
+   * limitée à 10 événements, puis une table sans limite
+   * qui doit dépasser sa capacité initiale.
+   */
+  for(j=10; j>=0; j-=10)
+    {
+      octets = NULL ;
+      taille = 0 ;
+      sf = open_shannon_fano_limite(j) ;
+      bs = open_bitstream_memory(&octets, &taille, "w") ;
+      for(i=0; i<3000; i++)
+	put_entier_shannon_fano(bs, sf, (i*7) % 1000) ;
+      if ( !sf_table_ok(sf) )
+	return ;
+      if ( sf_get_nb_evenements(sf) != (j ? j : 1001) )
+	{
+	  eprintf("Limite %d : la table a %d événements\n"
+		  , j, sf_get_nb_evenements(sf)) ;
+	  return ;
+	}
+      close_bitstream(bs) ;
+      close_shannon_fano(sf) ;
+
+      sf = open_shannon_fano_limite(j) ;
+      bs = open_bitstream_memory(&octets, &taille, "r") ;
+      for(i=0; i<3000; i++)
+	if ( get_entier_shannon_fano(bs, sf) != (i*7) % 1000 )
+	  {
+	    eprintf("Limite %d : la valeur %d est mal décodée\n", j, i) ;
+	    return ;
+	  }
+      close_bitstream(bs) ;
+      close_shannon_fano(sf) ;
+      free(octets) ;
+    }
+}
+
+/*
+ * Valeurs de test du mode semi-adaptatif : beaucoup de 0,
+ * quelques négatifs et 3000 valeurs rares (codes de plus de 10 bits).
+ */
+static int valeur_fenetre(int i)
+{
+  if ( i % 3 )
+    return i % 7 ? 0 : -(i % 5) ;
+  return (i*37) % 3000 ;
+}
+
+void open_shannon_fano_fenetre_tst()
+{
+  static const int fenetres[] = { 1, 7, 1000 } ;
+  struct shannon_fano *sf ;
+  struct bitstream *bs ;
+  unsigned char *octets ;
+  size_t taille ;
+  int i, j ;
+
+  for(j=0; j<3; j++)
+    {
+      octets = NULL ;
+      taille = 0 ;
+      sf = open_shannon_fano_fenetre(fenetres[j]) ;
+      bs = open_bitstream_memory(&octets, &taille, "w") ;
+      for(i=0; i<20000; i++)
+	put_entier_shannon_fano(bs, sf, valeur_fenetre(i)) ;
+      close_bitstream(bs) ;
+      close_shannon_fano(sf) ;
+
+      sf = open_shannon_fano_fenetre(fenetres[j]) ;
+      bs = open_bitstream_memory(&octets, &taille, "r") ;
+      for(i=0; i<20000; i++)
+	if ( get_entier_shannon_fano(bs, sf) != valeur_fenetre(i) )
+	  {
+	    eprintf("Fenêtre %d : la valeur %d est mal décodée\n"
+		    , fenetres[j], i) ;
+	    return ;
+	  }
+      close_bitstream(bs) ;
+      close_shannon_fano(sf) ;
+      free(octets) ;
+    }
+
+  /*
+   * Démarrage à froid : les premières fenêtres sont courtes,
+   * 4096 valeurs nulles ne sont pas toutes envoyées par ESCAPE
+   * (33 bits chacune) mais presque toutes avec un code de 1 bit.
+   */
+  octets = NULL ;
+  taille = 0 ;
+  sf = open_shannon_fano_fenetre(4096) ;
+  bs = open_bitstream_memory(&octets, &taille, "w") ;
+  for(i=0; i<4096; i++)
+    put_entier_shannon_fano(bs, sf, 0) ;
+  close_bitstream(bs) ;
+  close_shannon_fano(sf) ;
+  free(octets) ;
+  if ( taille > 1024 )
+    {
+      eprintf("Fenêtre 4096 : %d octets pour 4096 valeurs nulles\n"
+	      , (int)taille) ;
+      return ;
+    }
+}
+
+/*
+ * Modèle entraîné sur les 20000 premières valeurs de "valeur_fenetre"
+ * (dans un "bitstream" en mémoire).
+ */
+static void modele_entraine(unsigned char **modele, size_t *taille_modele)
+{
+  struct shannon_fano *sf ;
+  struct bitstream *bs ;
+  unsigned char *octets ;
+  size_t taille ;
+  int i ;
+
+  octets = NULL ;
+  taille = 0 ;
+  sf = open_shannon_fano() ;
+  bs = open_bitstream_memory(&octets, &taille, "w") ;
+  for(i=0; i<20000; i++)
+    put_entier_shannon_fano(bs, sf, valeur_fenetre(i)) ;
+  close_bitstream(bs) ;
+  free(octets) ;
+
+  *modele = NULL ;
+  *taille_modele = 0 ;
+  bs = open_bitstream_memory(modele, taille_modele, "w") ;
+  sauve_shannon_fano(bs, sf) ;
+  close_bitstream(bs) ;
+  close_shannon_fano(sf) ;
+}
+
+static struct shannon_fano* charge_modele(unsigned char **modele
+					  , size_t *taille_modele
+					  , int fenetre)
+{
+  struct shannon_fano *sf ;
+  struct bitstream *bs ;
+
+  if ( modele == NULL )
+    return fenetre ? open_shannon_fano_fenetre(fenetre) : open_shannon_fano() ;
+  bs = open_bitstream_memory(modele, taille_modele, "r") ;
+  sf = open_shannon_fano_modele(bs, fenetre) ;
+  close_bitstream(bs) ;
+  return sf ;
+}
+
+/*
+ * Code 500 autres valeurs en partant du modèle (ou d'un modèle vide
+ * si "modele" est NULL), les relit et retourne la taille (-1 si erreur).
+ */
+static int modele_test(unsigned char **modele, size_t *taille_modele
+		       , int fenetre)
+{
+  struct shannon_fano *sf ;
+  struct bitstream *bs ;
+  unsigned char *octets ;
+  size_t taille ;
+  int i, v ;
+
+  octets = NULL ;
+  taille = 0 ;
+  sf = charge_modele(modele, taille_modele, fenetre) ;
+  bs = open_bitstream_memory(&octets, &taille, "w") ;
+  for(i=0; i<500; i++)
+    put_entier_shannon_fano(bs, sf, valeur_fenetre(i + 30001)) ;
+  close_bitstream(bs) ;
+  close_shannon_fano(sf) ;
+
+  sf = charge_modele(modele, taille_modele, fenetre) ;
+  if ( !fenetre && (!sf_arbre_ok(sf) || !sf_series_ok(sf)) )
+    {
+      eprintf("Le modèle chargé est faux\n") ;
+      return -1 ;
+    }
+  bs = open_bitstream_memory(&octets, &taille, "r") ;
+  for(i=0; i<500; i++)
+    {
+      v = get_entier_shannon_fano(bs, sf) ;
+      if ( v != valeur_fenetre(i + 30001) )
+	{
+	  eprintf("Fenêtre %d : la valeur %d vaut %d au lieu de %d\n"
+		  , fenetre, i, v, valeur_fenetre(i + 30001)) ;
+	  return -1 ;
+	}
+    }
+  close_bitstream(bs) ;
+  close_shannon_fano(sf) ;
+  free(octets) ;
+  return taille ;
+}
+
+void open_shannon_fano_modele_tst()
+{
+  static const int fenetres[] = { 0, 1, 100 } ;
+  unsigned char *modele ;
+  size_t taille_modele ;
+  int j, avec, sans ;
+
+  modele_entraine(&modele, &taille_modele) ;
+  for(j=0; j<TAILLE(fenetres); j++)
+    {
+      avec = modele_test(&modele, &taille_modele, fenetres[j]) ;
+      sans = modele_test(NULL, NULL, fenetres[j]) ;
+      if ( avec < 0 || sans < 0 )
+	break ;
+      if ( avec >= sans )
+	{
+	  eprintf("Fenêtre %d : %d octets avec le modèle, %d sans\n"
+		  , fenetres[j], avec, sans) ;
+	  break ;
+	}
+    }
+  free(modele) ;
+}
+
 void close_shannon_fano_tst()
 {
 /*
@@ -242,6 +468,50 @@ static int aleatoire2(int n)
 }
 
 
+/*
+ * La séparation calculée doit être celle de l'algorithme trivial.
+ */
+
+static int separation_triviale(struct shannon_fano *sf, int min, int max)
+{
+  int v, occ_min, occ_max, sum_min, sum_max ;
+
+  sf_get_evenement(sf, min, &v, &sum_min) ;
+  sf_get_evenement(sf, max, &v, &sum_max) ;
+  while( min != max - 1 )
+    {
+      if ( sum_max < sum_min )
+	{
+	  sf_get_evenement(sf, --max, &v, &occ_max) ;
+	  sum_max += occ_max ;
+	}
+      else
+	{
+	  sf_get_evenement(sf, ++min, &v, &occ_min) ;
+	  sum_min += occ_min ;
+	}
+    }
+  return min ;
+}
+
+static int separations_ok(struct shannon_fano *sf)
+{
+  int min, max, n ;
+
+  n = sf_get_nb_evenements(sf) ;
+  for(min=0; min<n; min++)
+    for(max=min+1; max<n; max = max < min + 64 ? max + 1 : 2*max)
+      if ( sf_trouve_separation(sf, min, max)
+	   != separation_triviale(sf, min, max) )
+	{
+	  eprintf("Mauvaise séparation de [%d..%d] : %d au lieu de %d\n"
+		  , min, max, sf_trouve_separation(sf, min, max)
+		  , separation_triviale(sf, min, max)) ;
+	  return 0 ;
+	}
+  return 1 ;
+}
+
 void get_entier_shannon_fano_tst()
 {
   struct shannon_fano *sf ;
@@ -261,6 +531,13 @@ void get_entier_shannon_fano_tst()
 	{
 	put_entier_shannon_fano(bs, sf, (*t[k])(i)) ;
 	sf_table_ok(sf) ;
+	if ( i % 500 == 0 && !separations_ok(sf) )
+	  return ;
+	if ( !sf_arbre_ok(sf) || !sf_series_ok(sf) )
+	  {
+	    eprintf("Modèle faux après %d valeurs\n", i + 1000) ;
+	    return ;
+	  }
 	}
       close_bitstream(bs) ;
       close_shannon_fano(sf) ;
@@ -272,6 +549,11 @@ void get_entier_shannon_fano_tst()
 	{
 	  j = get_entier_shannon_fano(bs, sf) ;
     sf_table_ok(sf) ;
+	  if ( !sf_arbre_ok(sf) || !sf_series_ok(sf) )
+	    {
+	      eprintf("Modèle faux en décodage\n") ;
+	      return ;
+	    }
 	  if ( j != (*t[k])(i) )
 	    {
 	      eprintf("Compresse/Décompresse %s\n", tt[k]) ;
@@ -283,3 +565,98 @@ void get_entier_shannon_fano_tst()
       close_shannon_fano(sf) ;
     }
 }
+
+void sauve_shannon_fano_tst()
+{
+  struct shannon_fano *sf ;
+  struct bitstream *bs ;
+  unsigned char *octets ;
+  size_t taille ;
+  int i, valeur, nb_occ, escape ;
+  long somme ;
+
+  /* Les occurrences sont réduites mais l'ordre est gardé */
+  octets = NULL ;
+  taille = 0 ;
+  sf = open_shannon_fano() ;
+  bs = open_bitstream_memory(&octets, &taille, "w") ;
+  for(i=0; i<200000; i++)
+    put_entier_shannon_fano(bs, sf, i % 10 ? i % 3 : i % 1000) ;
+  close_bitstream(bs) ;
+  free(octets) ;
+
+  octets = NULL ;
+  taille = 0 ;
+  bs = open_bitstream_memory(&octets, &taille, "w") ;
+  sauve_shannon_fano(bs, sf) ;
+  close_bitstream(bs) ;
+  i = sf_get_nb_evenements(sf) ;
+  close_shannon_fano(sf) ;
+
+  bs = open_bitstream_memory(&octets, &taille, "r") ;
+  sf = open_shannon_fano_modele(bs, 0) ;
+  close_bitstream(bs) ;
+  free(octets) ;
+  if ( sf_get_nb_evenements(sf) != i )
+    {
+      eprintf("%d événements relus au lieu de %d\n"
+	      , sf_get_nb_evenements(sf), i) ;
+      return ;
+    }
+  somme = 0 ;
+  escape = 0 ;
+  for(i=0; i<sf_get_nb_evenements(sf); i++)
+    {
+      sf_get_evenement(sf, i, &valeur, &nb_occ) ;
+      somme += nb_occ ;
+      escape += valeur == 0x7fffffff ;
+      if ( i < 3 && (valeur < 0 || valeur > 2) )
+	{
+	  eprintf("Les valeurs fréquentes ne sont plus en tête\n") ;
+	  return ;
+	}
+    }
+  if ( escape != 1 || somme > 65536 || !sf_table_ok(sf) )
+    {
+      eprintf("Modèle relu faux (ESCAPE %d fois, %ld occurrences)\n"
+	      , escape, somme) ;
+      return ;
+    }
+  close_shannon_fano(sf) ;
+
+  /*
+   * Plus de 65536 événements : la somme ne peut pas être réduite
+   * sous la limite, chaque événement est sauvé avec une occurrence.
+   */
+  octets = NULL ;
+  taille = 0 ;
+  sf = open_shannon_fano() ;
+  bs = open_bitstream_memory(&octets, &taille, "w") ;
+  for(i=0; i<70000; i++)
+    put_entier_shannon_fano(bs, sf, i) ;
+  put_entier_shannon_fano(bs, sf, 0) ;
+  close_bitstream(bs) ;
+  free(octets) ;
+
+  octets = NULL ;
+  taille = 0 ;
+  bs = open_bitstream_memory(&octets, &taille, "w") ;
+  sauve_shannon_fano(bs, sf) ;
+  close_bitstream(bs) ;
+  close_shannon_fano(sf) ;
+
+  bs = open_bitstream_memory(&octets, &taille, "r") ;
+  sf = open_shannon_fano_modele(bs, 0) ;
+  close_bitstream(bs) ;
+  free(octets) ;
+  somme = 0 ;
+  for(i=0; i<sf_get_nb_evenements(sf); i++)
+    {
+      sf_get_evenement(sf, i, &valeur, &nb_occ) ;
+      somme += nb_occ ;
+    }
+  if ( sf_get_nb_evenements(sf) != 70001 || somme != 70001 )
+    eprintf("70000 valeurs : %d événements, %ld occurrences relus\n"
+	    , sf_get_nb_evenements(sf), somme) ;
+  close_shannon_fano(sf) ;
+}
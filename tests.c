@@ -61,6 +61,7 @@ int main(int argc, char **argv)
 		 F(Exception_fichier_ecriture_dans_fichier_ouvert_en_lecture) ;
 		 F(Exception_fichier_lecture_dans_fichier_ouvert_en_ecriture) ;
 		 F(Exception_arbre_shannon_fano_invalide) ;
+		 F(Exception_marqueur_segment_absent) ;
 		 ) ;
 	      exit(r) ;
 	    }
@@ -4,20 +4,58 @@ void pow2_tst() ;
 void prend_bit_tst() ;
 void pose_bit_tst() ;
 void open_bitstream_tst() ;
+void open_bitstream_memory_tst() ;
+void open_bitstream_memory_read_tst() ;
 void close_bitstream_tst() ;
 void put_bit_tst() ;
 void get_bit_tst() ;
+void put_mot_tst() ;
+void get_mot_tst() ;
+void peek_mot_tst() ;
+void skip_mot_tst() ;
+void align_bitstream_tst() ;
+void put_octets_tst() ;
+void get_octets_tst() ;
+void put_marqueur_segment_tst() ;
+void get_marqueur_segment_tst() ;
 void put_bits_tst() ;
 void get_bits_tst() ;
+void peek_bits_tst() ;
+void skip_bits_tst() ;
 void put_bit_string_tst() ;
 void put_entier_tst() ;
 void get_entier_tst() ;
 void put_entier_signe_tst() ;
 void get_entier_signe_tst() ;
+void put_exp_golomb_tst() ;
+void get_exp_golomb_tst() ;
 void open_shannon_fano_tst() ;
+void open_shannon_fano_limite_tst() ;
+void open_shannon_fano_fenetre_tst() ;
+void open_shannon_fano_modele_tst() ;
 void close_shannon_fano_tst() ;
 void put_entier_shannon_fano_tst() ;
 void get_entier_shannon_fano_tst() ;
+void sauve_shannon_fano_tst() ;
+void open_huffman_tst() ;
+void close_huffman_tst() ;
+void put_entier_huffman_tst() ;
+void vide_huffman_tst() ;
+void get_entier_huffman_tst() ;
+void open_intervalle_tst() ;
+void close_intervalle_tst() ;
+void put_entier_intervalle_tst() ;
+void vide_intervalle_tst() ;
+void get_entier_intervalle_tst() ;
+void open_rans_tst() ;
+void close_rans_tst() ;
+void put_entier_rans_tst() ;
+void vide_rans_tst() ;
+void get_entier_rans_tst() ;
+void open_rice_tst() ;
+void close_rice_tst() ;
+void put_entier_rice_tst() ;
+void get_entier_rice_tst() ;
 void allocation_matrice_float_tst() ;
 void liberation_matrice_float_tst() ;
 void coef_dct_tst() ;
@@ -25,6 +63,11 @@ void dct_tst() ;
 void psycho_tst() ;
 void compresse_tst() ;
 void decompresse_tst() ;
+void compresse_bandes_tst() ;
+void decompresse_bandes_tst() ;
+void compresse_joint_tst() ;
+void decompresse_joint_tst() ;
+void termine_joint_tst() ;
 void lire_ligne_tst() ;
 void allocation_image_tst() ;
 void liberation_image_tst() ;
@@ -37,3 +80,5 @@ void ondelette_1d_tst() ;
 void ondelette_2d_tst() ;
 void ondelette_1d_inverse_tst() ;
 void ondelette_2d_inverse_tst() ;
+void codage_ondelette_bitstream_tst() ;
+void decodage_ondelette_bitstream_tst() ;
@@ -4,20 +4,58 @@
 { "prend_bit", prend_bit_tst },
 { "pose_bit", pose_bit_tst },
 { "open_bitstream", open_bitstream_tst },
+{ "open_bitstream_memory", open_bitstream_memory_tst },
+{ "open_bitstream_memory_read", open_bitstream_memory_read_tst },
 { "close_bitstream", close_bitstream_tst },
 { "put_bit", put_bit_tst },
 { "get_bit", get_bit_tst },
+{ "put_mot", put_mot_tst },
+{ "get_mot", get_mot_tst },
+{ "peek_mot", peek_mot_tst },
+{ "skip_mot", skip_mot_tst },
+{ "align_bitstream", align_bitstream_tst },
+{ "put_octets", put_octets_tst },
+{ "get_octets", get_octets_tst },
+{ "put_marqueur_segment", put_marqueur_segment_tst },
+{ "get_marqueur_segment", get_marqueur_segment_tst },
 { "put_bits", put_bits_tst },
 { "get_bits", get_bits_tst },
+{ "peek_bits", peek_bits_tst },
+{ "skip_bits", skip_bits_tst },
 { "put_bit_string", put_bit_string_tst },
 { "put_entier", put_entier_tst },
 { "get_entier", get_entier_tst },
 { "put_entier_signe", put_entier_signe_tst },
 { "get_entier_signe", get_entier_signe_tst },
+{ "put_exp_golomb", put_exp_golomb_tst },
+{ "get_exp_golomb", get_exp_golomb_tst },
 { "open_shannon_fano", open_shannon_fano_tst },
+{ "open_shannon_fano_limite", open_shannon_fano_limite_tst },
+{ "open_shannon_fano_fenetre", open_shannon_fano_fenetre_tst },
+{ "open_shannon_fano_modele", open_shannon_fano_modele_tst },
 { "close_shannon_fano", close_shannon_fano_tst },
 { "put_entier_shannon_fano", put_entier_shannon_fano_tst },
 { "get_entier_shannon_fano", get_entier_shannon_fano_tst },
+{ "sauve_shannon_fano", sauve_shannon_fano_tst },
+{ "open_huffman", open_huffman_tst },
+{ "close_huffman", close_huffman_tst },
+{ "put_entier_huffman", put_entier_huffman_tst },
+{ "vide_huffman", vide_huffman_tst },
+{ "get_entier_huffman", get_entier_huffman_tst },
+{ "open_intervalle", open_intervalle_tst },
+{ "close_intervalle", close_intervalle_tst },
+{ "put_entier_intervalle", put_entier_intervalle_tst },
+{ "vide_intervalle", vide_intervalle_tst },
+{ "get_entier_intervalle", get_entier_intervalle_tst },
+{ "open_rans", open_rans_tst },
+{ "close_rans", close_rans_tst },
+{ "put_entier_rans", put_entier_rans_tst },
+{ "vide_rans", vide_rans_tst },
+{ "get_entier_rans", get_entier_rans_tst },
+{ "open_rice", open_rice_tst },
+{ "close_rice", close_rice_tst },
+{ "put_entier_rice", put_entier_rice_tst },
+{ "get_entier_rice", get_entier_rice_tst },
 { "allocation_matrice_float", allocation_matrice_float_tst },
 { "liberation_matrice_float", liberation_matrice_float_tst },
 { "coef_dct", coef_dct_tst },
@@ -25,6 +63,11 @@
 { "psycho", psycho_tst },
 { "compresse", compresse_tst },
 { "decompresse", decompresse_tst },
+{ "compresse_bandes", compresse_bandes_tst },
+{ "decompresse_bandes", decompresse_bandes_tst },
+{ "compresse_joint", compresse_joint_tst },
+{ "decompresse_joint", decompresse_joint_tst },
+{ "termine_joint", termine_joint_tst },
 { "lire_ligne", lire_ligne_tst },
 { "allocation_image", allocation_image_tst },
 { "liberation_image", liberation_image_tst },
@@ -37,3 +80,5 @@
 { "ondelette_2d", ondelette_2d_tst },
 { "ondelette_1d_inverse", ondelette_1d_inverse_tst },
 { "ondelette_2d_inverse", ondelette_2d_inverse_tst },
+{ "codage_ondelette_bitstream", codage_ondelette_bitstream_tst },
+{ "decodage_ondelette_bitstream", decodage_ondelette_bitstream_tst },